@@ -0,0 +1,139 @@
+/**********************************************
+ * @file odometry_archive.h
+ * @brief Compact delta-encoded archive for long-duration
+ * encoder and odometry logs.
+ **********************************************/
+
+#pragma once
+
+#include "odometry_wheels.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace farmwise_odometry
+{
+
+/**
+ * An archive is a sequence of independently decodable chunks. Each chunk holds
+ * the records of a single stream:
+ *
+ *   magic        u32   'FWCK'
+ *   stream       u8    ArchiveStream
+ *   encoder_bits u8    resolution of the encoder stream, 0 for odometry
+ *   count        u32   number of records in the chunk
+ *   payload_size u32   size in bytes of the payload that follows
+ *   payload            base value, then one delta record per sample
+ *
+ * Encoder records store the tick delta unwrapped at encoder_bits and the
+ * delta-of-delta of the timestamp in nanoseconds, both as zigzag varints. For
+ * a 50 Hz stream latched on 20 ms, the timestamp field is a single zero byte.
+ * Odometry records store the delta of the float bit pattern instead of ticks.
+ */
+enum class ArchiveStream : uint8_t
+{
+    LeftEncoder = 0,
+    RightEncoder = 1,
+    Odometry = 2,
+};
+
+class ArchiveWriter
+{
+public:
+    static constexpr size_t default_chunk_records = 4096;
+
+    /**
+     * The encoder bits, in [2, 62], give the tick range of each wheel, as in
+     * EncoderModel::bits.
+     */
+    explicit ArchiveWriter(std::ostream& out, size_t chunk_records = default_chunk_records,
+                           int left_encoder_bits = Encoder24::bits, int right_encoder_bits = Encoder24::bits);
+
+    /**
+     * Flushes any partially filled chunk.
+     */
+    ~ArchiveWriter();
+
+    /**
+     * @return false if the tick is outside of the encoder range, in which case
+     * the record is not archived.
+     */
+    bool append(const EncoderValue& encoder_value, const bool is_left);
+    void append(const OdometryValue& odometry_value);
+
+    /**
+     * Writes every partially filled chunk to the output stream.
+     */
+    void flush(void);
+
+    /**
+     * @return the number of bytes written to the output stream so far.
+     */
+    uint64_t bytesWritten(void) const { return bytes_written_; };
+
+private:
+    struct ChunkEncoder
+    {
+        ArchiveStream stream;
+        int bits;
+        uint32_t count;
+        int64_t last_value;
+        uint64_t last_time;
+        int64_t last_time_delta;
+        std::vector<uint8_t> payload;
+    };
+
+    void appendRecord(ChunkEncoder& chunk, int64_t value_delta, int64_t value, uint64_t time);
+    void flushChunk(ChunkEncoder& chunk);
+
+    std::ostream& out_;
+    size_t chunk_records_;
+    uint64_t bytes_written_;
+    ChunkEncoder left_chunk_, right_chunk_, odom_chunk_;
+};
+
+class ArchiveReader
+{
+public:
+    explicit ArchiveReader(std::istream& in);
+
+    /**
+     * Reads and decodes the next chunk of the archive.
+     * @return false at the end of the archive or if the chunk is corrupted.
+     */
+    bool nextChunk(void);
+
+    /**
+     * @return true if reading stopped on a malformed chunk rather than at the end of the archive.
+     */
+    bool corrupted(void) const { return corrupted_; };
+
+    /**
+     * Stream of the last decoded chunk. Encoder chunks populate encoderValues(),
+     * odometry chunks populate odometryValues().
+     */
+    ArchiveStream stream(void) const { return stream_; };
+
+    /**
+     * Resolution of the encoder that recorded the last decoded encoder chunk.
+     */
+    int encoderBits(void) const { return encoder_bits_; };
+    const std::vector<EncoderValue>& encoderValues(void) const { return encoder_values_; };
+    const std::vector<OdometryValue>& odometryValues(void) const { return odometry_values_; };
+
+private:
+    bool decodeEncoderChunk(const uint8_t* data, const uint8_t* end, uint32_t count);
+    bool decodeOdometryChunk(const uint8_t* data, const uint8_t* end, uint32_t count);
+
+    std::istream& in_;
+    bool corrupted_;
+    ArchiveStream stream_;
+    int encoder_bits_;
+    std::vector<uint8_t> payload_;
+    std::vector<EncoderValue> encoder_values_;
+    std::vector<OdometryValue> odometry_values_;
+};
+}  // namespace farmwise_odometry
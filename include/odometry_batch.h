@@ -0,0 +1,69 @@
+/**********************************************
+ * @file odometry_batch.h
+ * @brief Offline replay of encoder log archives through
+ * FarmwiseOdometryWheels, many logs in parallel.
+ **********************************************/
+
+#pragma once
+
+#include "odometry_archive.h"
+
+#include <chrono>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace farmwise_odometry
+{
+
+struct BatchOptions
+{
+    int ticks_per_meter = 0;
+    std::chrono::nanoseconds encoder_period = Encoder24::nominal_period;  // Nominal period of each encoder stream
+    unsigned threads = 0;    // Worker threads, 0 for one per core
+    size_t chunk_logs = 4;   // Logs handed to a worker at a time
+};
+
+struct LogSummary
+{
+    std::string path;
+    bool ok = false;                    // false if the log could not be read, is corrupted or not 24-bit
+    uint64_t left_samples = 0, right_samples = 0;
+    uint64_t paired_samples = 0;        // Left and right samples sharing a timestamp, counted once per pair
+    uint64_t unpaired_samples = 0;      // Samples without a matching sample from the other wheel
+    uint64_t dropped_left_samples = 0, dropped_right_samples = 0;  // Missing from the nominal encoder period
+    uint64_t odometry_updates = 0;
+    double duration = 0;                // Seconds between the first and last paired samples
+    double distance = 0;                // Signed distance travelled in meters
+    double mean_speed = 0, stddev_speed = 0;
+    float min_speed = 0, max_speed = 0;
+};
+
+/**
+ * Replays one archive through a dedicated, thread-less FarmwiseOdometryWheels.
+ * Left and right samples are merged by timestamp: samples sharing a timestamp
+ * are processed as a pair and followed by an odometry update, the others are
+ * processed alone, as a lagging stream would be.
+ * @return false if the archive is corrupted or holds encoder chunks of another
+ * resolution than Encoder24, summary then covers what was read before.
+ */
+bool summarizeLog(std::istream& in, const BatchOptions& options, LogSummary& summary);
+
+/**
+ * Runs job(i) for every i in [0, count) on options.threads workers, each
+ * taking options.chunk_logs consecutive indices at a time from a shared counter.
+ */
+void parallelFor(size_t count, const BatchOptions& options, const std::function<void(size_t)>& job);
+
+/**
+ * Summarizes every archive in paths in parallel, in the order of paths.
+ */
+std::vector<LogSummary> summarizeLogs(const std::vector<std::string>& paths, const BatchOptions& options);
+
+/**
+ * Writes summaries as CSV with a header line.
+ */
+void writeSummaries(std::ostream& out, const std::vector<LogSummary>& summaries);
+}  // namespace farmwise_odometry
@@ -0,0 +1,91 @@
+/**********************************************
+ * @file odometry_snapshot.h
+ * @brief Binary checkpoints of the estimator state, for
+ * warm start after a restart or a failover.
+ **********************************************/
+
+#pragma once
+
+#include "odometry_wheels.h"
+
+#include <condition_variable>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+
+namespace farmwise_odometry
+{
+
+/**
+ * An OdometrySnapshot is serialized as, little-endian:
+ *
+ *   magic                               u32  'FWSN'
+ *   version                             u16
+ *   ticks_per_meter                     i32
+ *   left_encoder, right_encoder         u8 bits, i8 direction, u16 rate_hz
+ *   last_left_tick, last_right_tick     i64
+ *   last_left_update, last_right_update i64  nanoseconds, INT64_MIN if none
+ *   left_speed, right_speed             f32
+ *   last_pair_update                    i64  nanoseconds, INT64_MIN if none
+ *   flags                               u8   bit 0 has_left_speed, bit 1 has_right_speed
+ *   next_output                         i64  nanoseconds, INT64_MIN if none
+ *   left_history, right_history         u16 count, then count x (i64 nanoseconds, f32 speed)
+ *   checksum                            u32  FNV-1a of all the previous bytes
+ *
+ * With full histories a snapshot takes about 1.6 kB.
+ */
+bool writeSnapshot(std::ostream& out, const OdometrySnapshot& snapshot);
+
+/**
+ * @return false if the input is truncated, corrupted or of an unknown version,
+ * in which case snapshot is left in an unspecified state.
+ */
+bool readSnapshot(std::istream& in, OdometrySnapshot& snapshot);
+
+/**
+ * Writes to a temporary file renamed over path, so a crash while saving never
+ * leaves a torn snapshot behind.
+ */
+bool saveSnapshot(const std::string& path, const OdometrySnapshot& snapshot);
+bool loadSnapshot(const std::string& path, OdometrySnapshot& snapshot);
+
+/**
+ * Periodically checkpoints an estimator to a file from its own thread. The
+ * state is copied with BasicFarmwiseOdometryWheels::trySnapshot, so the encoder
+ * and odometry threads wait for at most that fixed-size copy. Serialization and
+ * file I/O happen outside of the estimator lock.
+ */
+class SnapshotWriter
+{
+public:
+    template <typename LeftEncoder, typename RightEncoder>
+    SnapshotWriter(BasicFarmwiseOdometryWheels<LeftEncoder, RightEncoder>& odometry_wheels, const std::string& path,
+                   std::chrono::milliseconds period)
+        : SnapshotWriter([&odometry_wheels](OdometrySnapshot& snapshot) { return odometry_wheels.trySnapshot(snapshot); },
+                         path, period)
+    {
+    };
+
+    /**
+     * Blocking. Stops the thread and writes a last snapshot.
+     */
+    ~SnapshotWriter();
+
+private:
+    SnapshotWriter(std::function<bool(OdometrySnapshot&)> try_snapshot, const std::string& path,
+                   std::chrono::milliseconds period);
+
+    void callbackSnapshot(void);
+    bool checkpoint(void);
+
+    const std::function<bool(OdometrySnapshot&)> try_snapshot_;
+    const std::string path_;
+    const std::chrono::milliseconds period_;
+    OdometrySnapshot snapshot_;
+    std::mutex mutex_;
+    std::condition_variable stop_condition_;
+    bool stop_thread_;
+    std::thread thread_;
+};
+}  // namespace farmwise_odometry
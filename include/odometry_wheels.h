@@ -9,8 +9,11 @@
 
 #include <boost/lockfree/queue.hpp>
 #include <boost/thread/thread.hpp>
+#include <array>
+#include <atomic>
 #include <chrono>
 #include <ctime>
+#include <mutex>
 #include <thread>
 #include <iostream>
 
@@ -45,22 +48,41 @@ class OdometryWheels
 public:
     ~OdometryWheels()
     {
-        stop_threads_ = true;
-        for (auto& internal_thread : internal_threads_)
-        {
-            internal_thread.join();
-        }
+        stop();
     };
 
     /**
      * Non-blocking.
      * To be called to start processing encoder data and producing odometry updates.
+     * Does nothing if already started. After stop(), processing resumes from the
+     * queued updates. Must not be called concurrently with stop().
      */
     void start(void)
     {
-        internal_threads_.push_back(std::thread(&OdometryWheels::callbackLeftEncoder, this));
-        internal_threads_.push_back(std::thread(&OdometryWheels::callbackRightEncoder, this));
-        internal_threads_.push_back(std::thread(&OdometryWheels::callbackOdometry, this));
+        if (internal_threads_[0].joinable())
+        {
+            return;
+        }
+        stop_threads_ = false;
+        internal_threads_[0] = std::thread(&OdometryWheels::callbackLeftEncoder, this);
+        internal_threads_[1] = std::thread(&OdometryWheels::callbackRightEncoder, this);
+        internal_threads_[2] = std::thread(&OdometryWheels::callbackOdometry, this);
+    };
+
+    /**
+     * Blocking. Stops processing and joins the internal threads. Subclasses
+     * must call it from their destructor, before their state is destroyed.
+     */
+    void stop(void)
+    {
+        stop_threads_ = true;
+        for (auto& internal_thread : internal_threads_)
+        {
+            if (internal_thread.joinable())
+            {
+                internal_thread.join();
+            }
+        }
     };
 
     /**
@@ -85,27 +107,23 @@ public:
      * @return true if a new update is available, in which case new_update gets populated.
      */
     bool getOdometryUpdate(OdometryValue& new_update) {
-        // return odom_queue_.pop(new_update);
-
-        bool ret = odom_queue_.pop(new_update);
-        std::cout << "[getOdometryUpdate] speed: " << new_update.speed 
-            << ", new_update.timestamp: " << new_update.timestamp.secs << ":" << new_update.timestamp.nsecs 
-            << ", return: " << ret
-            << ", odom_queue_ is empty: " << odom_queue_.empty()
-            << std::endl;
-
-        return ret;
+        return odom_queue_.pop(new_update);
     };
 
 protected:
     /**
      * Must be called to instantiate subclasses. Subclasses should choose
      * an appropriate encoder_queue_size.
+     * A non-zero odometry_period switches the odometry thread from polling to
+     * timer-driven wakeups on that period, draining every available update on
+     * each wakeup.
      */
-    OdometryWheels(int encoder_queue_size, int odometry_queue_size)
+    OdometryWheels(int encoder_queue_size, int odometry_queue_size,
+                   std::chrono::nanoseconds odometry_period = std::chrono::nanoseconds::zero())
           : left_encoder_queue_(encoder_queue_size)
           , right_encoder_queue_(encoder_queue_size)
           , odom_queue_(odometry_queue_size)
+          , odometry_period_(odometry_period)
           , stop_threads_(false){};
 
     virtual bool updateOdometry(OdometryValue& odometry_value) = 0;
@@ -118,10 +136,12 @@ protected:
     boost::lockfree::queue<OdometryValue, boost::lockfree::fixed_sized<true>>
         odom_queue_;
 
+    const std::chrono::nanoseconds odometry_period_;
+
 private:
     // Threads
-    std::vector<std::thread> internal_threads_;
-    bool stop_threads_;
+    std::array<std::thread, 3> internal_threads_;
+    std::atomic<bool> stop_threads_;
 
     void callbackLeftEncoder(void)
     {
@@ -135,14 +155,10 @@ private:
             bool is_available = left_encoder_queue_.pop(left_encoder_update);
             if (is_available)
             {
-                std::cout << "[callbackLeftEncoder] pop succeed, left_encoder_queue_ is empty: " 
-                    << left_encoder_queue_.empty() << std::endl;
                 processLeftEncoder(left_encoder_update);
             }
             else
             {
-                // std::cout << "[callbackLeftEncoder] pop not succeed, left_encoder_queue_ is empty: " 
-                //    << left_encoder_queue_.empty() << std::endl;
                 std::this_thread::sleep_for(std::chrono::milliseconds(10));
             }
         }
@@ -171,6 +187,12 @@ private:
 
     void callbackOdometry(void)
     {
+        if (odometry_period_ > std::chrono::nanoseconds::zero())
+        {
+            callbackPeriodicOdometry();
+            return;
+        }
+
         while (true)
         {
             if (stop_threads_)
@@ -181,37 +203,281 @@ private:
             bool is_available = updateOdometry(odometry_value);
             if (is_available)
             {
-                std::cout << "[callbackOdometry] updateOdometry available" << std::endl;
                 odom_queue_.push(odometry_value);
             }
             else
             {
-                std::cout << "[callbackOdometry] updateOdometry not available" << std::endl;
                 std::this_thread::sleep_for(std::chrono::milliseconds(10));
             }
         }
     };
+
+    /**
+     * Wakes up on absolute deadlines so the period does not drift with the
+     * processing time. The encoder threads still poll their queues every 10 ms
+     * when idle, so a grid tick is published at most 10 ms plus one
+     * odometry_period_ plus two scheduler wakeup latencies after the encoder
+     * update that completes it was queued. When the reader falls behind and the
+     * odometry queue is full, the oldest grid ticks are dropped.
+     */
+    void callbackPeriodicOdometry(void)
+    {
+        std::chrono::steady_clock::time_point next_wakeup = std::chrono::steady_clock::now();
+        while (true)
+        {
+            if (stop_threads_)
+            {
+                return;
+            }
+            OdometryValue odometry_value;
+            while (updateOdometry(odometry_value))
+            {
+                while (!odom_queue_.push(odometry_value))
+                {
+                    OdometryValue oldest_value;
+                    odom_queue_.pop(oldest_value);
+                }
+            }
+
+            // Skip missed deadlines instead of bursting to catch up.
+            next_wakeup += odometry_period_;
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            if (next_wakeup < now)
+            {
+                next_wakeup = now + odometry_period_;
+            }
+            std::this_thread::sleep_until(next_wakeup);
+        }
+    };
 };
 
 /**************
  * End of supplied code
  **************/
 
-class FarmwiseOdometryWheels : public OdometryWheels
+/**
+ * Run-time identity of an EncoderModel, recorded in snapshots.
+ */
+struct EncoderModelId
+{
+    int bits, direction, rate_hz;
+
+    bool operator==(const EncoderModelId& other) const
+    {
+        return bits == other.bits && direction == other.direction && rate_hz == other.rate_hz;
+    };
+    bool operator!=(const EncoderModelId& other) const { return !(*this == other); };
+};
+
+/**
+ * Compile-time description of an absolute encoder: its resolution in bits,
+ * its counting direction (-1 if the position decreases as the wheel turns
+ * forward) and its nominal output rate. The estimator uses the rate to bound
+ * the gap over which it unwraps ticks restored from a snapshot.
+ */
+template <int Bits, int Direction = 1, int RateHz = 50>
+struct EncoderModel
+{
+    static_assert(Bits >= 2 && Bits <= 62, "ticks and their deltas must fit in int64_t");
+    static_assert(Direction == 1 || Direction == -1, "direction is either 1 or -1");
+    static_assert(RateHz > 0, "rate must be positive");
+
+    static constexpr int bits = Bits;
+    static constexpr int direction = Direction;
+    static constexpr int rate_hz = RateHz;
+    static constexpr int64_t max_tick = (int64_t(1) << Bits) - 1;
+    static constexpr std::chrono::nanoseconds nominal_period{1000000000 / RateHz};
+
+    static constexpr EncoderModelId id(void) { return EncoderModelId{Bits, Direction, RateHz}; };
+
+    /**
+     * Forward distance in ticks from last_tick to tick, taking the shortest
+     * way around the encoder range. Branch-free: the difference is truncated to
+     * bits and sign-extended back.
+     */
+    static constexpr int64_t tickDelta(int64_t tick, int64_t last_tick)
+    {
+        return direction * (static_cast<int64_t>(static_cast<uint64_t>(tick - last_tick) << (64 - bits)) >> (64 - bits));
+    }
+};
+
+using Encoder16 = EncoderModel<16>;
+using Encoder24 = EncoderModel<24>;
+using Encoder32 = EncoderModel<32>;
+
+static_assert(Encoder24::max_tick == EncoderValue::max_tick, "EncoderValue describes a 24-bit encoder");
+static_assert(Encoder24::tickDelta(4, EncoderValue::max_tick - 15) == 20, "overflow");
+static_assert(Encoder24::tickDelta(EncoderValue::max_tick - 15, 4) == -20, "underflow");
+static_assert(EncoderModel<16, -1>::tickDelta(65530, 10) == 16, "reversed underflow");
+
+/**
+ * Fixed-capacity ring buffer of the most recent speeds of a wheel, used to
+ * interpolate the speed at an arbitrary time.
+ */
+class SpeedHistory
 {
 public:
-    FarmwiseOdometryWheels(int ticks_per_meter);
+    static constexpr size_t capacity = 64;
+
+    struct Sample
+    {
+        std::chrono::steady_clock::time_point time;
+        float speed;
+    };
+
+    SpeedHistory() : head_(0), size_(0) {};
+
+    /**
+     * Appends a sample, overwriting the oldest one when full.
+     * Samples must be pushed in strictly increasing time order.
+     */
+    void push(std::chrono::steady_clock::time_point time, float speed)
+    {
+        samples_[(head_ + size_) % capacity] = Sample{time, speed};
+        if (size_ < capacity)
+        {
+            size_++;
+        }
+        else
+        {
+            head_ = (head_ + 1) % capacity;
+        }
+    };
+
+    void clear(void) { head_ = 0; size_ = 0; };
+    bool empty(void) const { return size_ == 0; };
+    size_t size(void) const { return size_; };
+
+    /**
+     * @return the i-th retained sample, from the oldest one.
+     */
+    const Sample& at(size_t i) const { return samples_[(head_ + i) % capacity]; };
+    const Sample& oldest(void) const { return samples_[head_]; };
+    const Sample& latest(void) const { return samples_[(head_ + size_ - 1) % capacity]; };
+
+    /**
+     * Linearly interpolates the speed at time, which must lie within
+     * [oldest().time, latest().time]. Samples that are no longer needed to
+     * interpolate at time or later are discarded.
+     */
+    float interpolate(std::chrono::steady_clock::time_point time)
+    {
+        while (size_ > 1 && samples_[(head_ + 1) % capacity].time <= time)
+        {
+            head_ = (head_ + 1) % capacity;
+            size_--;
+        }
+
+        const Sample& before = samples_[head_];
+        if (size_ == 1 || before.time >= time)
+        {
+            return before.speed;
+        }
+        const Sample& after = samples_[(head_ + 1) % capacity];
+        float ratio = std::chrono::duration<float>(time - before.time).count()
+            / std::chrono::duration<float>(after.time - before.time).count();
+        return before.speed + (after.speed - before.speed) * ratio;
+    };
+
+private:
+    std::array<Sample, capacity> samples_;
+    size_t head_, size_;
+};
+
+/**
+ * Full state of a FarmwiseOdometryWheels estimator, enough for a restarted
+ * process to emit valid odometry on its first paired sample. The output period
+ * is configuration and is not part of it; the calibration and encoder models
+ * are recorded so that the state is only restored into a matching estimator.
+ * See odometry_snapshot.h for the binary format.
+ */
+struct OdometrySnapshot
+{
+    int ticks_per_meter;
+    EncoderModelId left_encoder, right_encoder;
+    int64_t last_left_tick, last_right_tick;
+    std::chrono::steady_clock::time_point last_left_update, last_right_update;
+    float left_speed, right_speed;
+    std::chrono::steady_clock::time_point last_pair_update;
+    bool has_left_speed, has_right_speed;
+    SpeedHistory left_history, right_history;
+    std::chrono::steady_clock::time_point next_output;
+};
+
+/**
+ * LeftEncoder and RightEncoder are EncoderModel instantiations, in any
+ * combination. The members are defined in odometry_wheels.inl.
+ */
+template <typename LeftEncoder, typename RightEncoder = LeftEncoder>
+class BasicFarmwiseOdometryWheels : public OdometryWheels
+{
+public:
+    /**
+     * With a zero output_period, odometry is emitted once both wheels have an
+     * update newer than the last emitted pair. Otherwise it is emitted on a
+     * fixed grid of output_period aligned to the encoder timestamps, with both
+     * wheel speeds interpolated to each grid tick.
+     * An encoder update that is not newer than the previous one of its wheel is
+     * discarded.
+     */
+    BasicFarmwiseOdometryWheels(int ticks_per_meter,
+                                std::chrono::nanoseconds output_period = std::chrono::nanoseconds::zero());
+
+    /**
+     * Warm start from the snapshot of a previous instance. The first encoder
+     * update of each wheel yields a speed against the restored ticks instead of
+     * being discarded. Updates older than the snapshot, or more than
+     * max_restore_gap_periods nominal encoder periods after it, restart the
+     * wheel, since the travel in between may have wrapped the encoder range.
+     * A snapshot of another calibration or encoder model is ignored, and the
+     * estimator starts cold.
+     */
+    BasicFarmwiseOdometryWheels(int ticks_per_meter, const OdometrySnapshot& snapshot,
+                                std::chrono::nanoseconds output_period = std::chrono::nanoseconds::zero());
+    ~BasicFarmwiseOdometryWheels();
+
+    /**
+     * Non-blocking. Copies the estimator state unless an encoder or odometry
+     * update is in progress. The copy holds the estimator lock, so an update
+     * arriving meanwhile waits for at most one fixed-size copy of the state,
+     * about 2 kB with full speed histories.
+     * @return false if the state is busy, in which case snapshot is untouched.
+     */
+    bool trySnapshot(OdometrySnapshot& snapshot);
+
+    /**
+     * @return true if the estimator was restored from a snapshot.
+     */
+    bool warmStarted(void) const { return warm_started_; };
+
+    static constexpr int max_restore_gap_periods = 5;
+
     bool updateOdometry(OdometryValue& odometry_value);
     void processLeftEncoder(const EncoderValue &encoder_value);
     void processRightEncoder(const EncoderValue &encoder_value);
 
 private:
+    bool updateResampledOdometry(OdometryValue& odometry_value);
+    static Timestamp toTimestamp(std::chrono::steady_clock::time_point time);
+
     int ticks_per_meter_;                       // Ticks per meter calibration for the wheels
     int64_t last_left_tick_, last_right_tick_;  // Last tick values for the left and right wheels
     std::chrono::steady_clock::time_point last_left_update_, last_right_update_;  // Last update times for the left and right wheels
     float left_speed_, right_speed_;            // Speeds of the left and right wheels
+    bool has_left_speed_, has_right_speed_;     // Whether the left and right speeds are known
+    bool warm_started_;                         // Whether the state was restored from a snapshot
+    bool left_restored_, right_restored_;       // Whether the last left and right ticks come from a snapshot
     std::mutex mutex_;                          // Mutex for thread safety
     std::chrono::steady_clock::time_point last_update_;  // Last update time for the odometry value
+    std::chrono::steady_clock::time_point last_pair_update_;  // Time both wheels had reached at the last odometry value
+    std::chrono::nanoseconds output_period_;    // Period of the resampled output grid, zero if disabled
+    SpeedHistory left_history_, right_history_; // Recent speeds of the left and right wheels
+    std::chrono::steady_clock::time_point next_output_;  // Next grid tick of the resampled output
 };
+
+using FarmwiseOdometryWheels = BasicFarmwiseOdometryWheels<Encoder24>;
+
+extern template class BasicFarmwiseOdometryWheels<Encoder24, Encoder24>;
 }  // namespace farmwise_odometry
 
+#include "odometry_wheels.inl"
@@ -0,0 +1,271 @@
+/**********************************************
+ * @file odometry_wheels.inl
+ * @brief Member definitions of BasicFarmwiseOdometryWheels,
+ * included by odometry_wheels.h.
+ **********************************************/
+
+#pragma once
+
+#include <algorithm>
+
+namespace farmwise_odometry
+{
+namespace detail
+{
+// Resampled output keeps every grid tick until it is read, one second at 100 Hz.
+constexpr int resampled_odometry_queue_size = 128;
+}  // namespace detail
+
+template <typename LeftEncoder, typename RightEncoder>
+BasicFarmwiseOdometryWheels<LeftEncoder, RightEncoder>::BasicFarmwiseOdometryWheels(int ticks_per_meter,
+                                                                        std::chrono::nanoseconds output_period)
+    : OdometryWheels(1000, output_period > std::chrono::nanoseconds::zero() ? detail::resampled_odometry_queue_size : 1,
+                     output_period), 
+        ticks_per_meter_(ticks_per_meter), 
+        last_left_tick_(0), last_right_tick_(0),
+        last_left_update_(std::chrono::steady_clock::time_point::min()), 
+        last_right_update_(std::chrono::steady_clock::time_point::min()), 
+        last_update_(std::chrono::steady_clock::time_point::min()), 
+        left_speed_(0), right_speed_(0),
+        has_left_speed_(false), has_right_speed_(false),
+        warm_started_(false), left_restored_(false), right_restored_(false),
+        last_pair_update_(std::chrono::steady_clock::time_point::min()),
+        output_period_(output_period),
+        next_output_(std::chrono::steady_clock::time_point::min())
+{
+}
+
+template <typename LeftEncoder, typename RightEncoder>
+BasicFarmwiseOdometryWheels<LeftEncoder, RightEncoder>::BasicFarmwiseOdometryWheels(int ticks_per_meter,
+                                                                        const OdometrySnapshot& snapshot,
+                                                                        std::chrono::nanoseconds output_period)
+    : BasicFarmwiseOdometryWheels(ticks_per_meter, output_period)
+{
+    if (snapshot.ticks_per_meter != ticks_per_meter || snapshot.left_encoder != LeftEncoder::id()
+        || snapshot.right_encoder != RightEncoder::id()) {
+        return;
+    }
+
+    warm_started_ = true;
+    left_restored_ = snapshot.last_left_update != std::chrono::steady_clock::time_point::min();
+    right_restored_ = snapshot.last_right_update != std::chrono::steady_clock::time_point::min();
+    last_left_tick_ = snapshot.last_left_tick;
+    last_right_tick_ = snapshot.last_right_tick;
+    last_left_update_ = snapshot.last_left_update;
+    last_right_update_ = snapshot.last_right_update;
+    left_speed_ = snapshot.left_speed;
+    right_speed_ = snapshot.right_speed;
+    last_pair_update_ = snapshot.last_pair_update;
+    has_left_speed_ = snapshot.has_left_speed;
+    has_right_speed_ = snapshot.has_right_speed;
+    left_history_ = snapshot.left_history;
+    right_history_ = snapshot.right_history;
+    next_output_ = snapshot.next_output;
+}
+
+template <typename LeftEncoder, typename RightEncoder>
+BasicFarmwiseOdometryWheels<LeftEncoder, RightEncoder>::~BasicFarmwiseOdometryWheels()
+{
+    // The internal threads call into this object
+    stop();
+}
+
+template <typename LeftEncoder, typename RightEncoder>
+bool BasicFarmwiseOdometryWheels<LeftEncoder, RightEncoder>::trySnapshot(OdometrySnapshot& snapshot) {
+    std::unique_lock<std::mutex> lock(mutex_, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return false;
+    }
+
+    snapshot.ticks_per_meter = ticks_per_meter_;
+    snapshot.left_encoder = LeftEncoder::id();
+    snapshot.right_encoder = RightEncoder::id();
+    snapshot.last_left_tick = last_left_tick_;
+    snapshot.last_right_tick = last_right_tick_;
+    snapshot.last_left_update = last_left_update_;
+    snapshot.last_right_update = last_right_update_;
+    snapshot.left_speed = left_speed_;
+    snapshot.right_speed = right_speed_;
+    snapshot.last_pair_update = last_pair_update_;
+    snapshot.has_left_speed = has_left_speed_;
+    snapshot.has_right_speed = has_right_speed_;
+    snapshot.left_history = left_history_;
+    snapshot.right_history = right_history_;
+    snapshot.next_output = next_output_;
+
+    return true;
+}
+
+template <typename LeftEncoder, typename RightEncoder>
+bool BasicFarmwiseOdometryWheels<LeftEncoder, RightEncoder>::updateOdometry(OdometryValue& odometry_value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (output_period_ > std::chrono::nanoseconds::zero()) {
+        return updateResampledOdometry(odometry_value);
+    }
+
+    // if (left_encoder_queue_.empty() && right_encoder_queue_.empty()) {
+    //     return false;
+    // }
+
+    // If it's the first read for either left or right, or both wheels have not
+    // moved past the last emitted pair yet
+    std::chrono::steady_clock::time_point pair_update = std::min(last_left_update_, last_right_update_);
+    if (!has_left_speed_ || !has_right_speed_ || pair_update <= last_pair_update_) {  
+        return false;
+    }
+    last_pair_update_ = pair_update;
+
+    // Calculate the average speed of the left and right wheels
+    float speed = (left_speed_ + right_speed_) / 2.0;
+
+    // Update the odometry value
+    odometry_value.speed = speed;
+    last_update_ = last_left_update_ > last_right_update_ ? last_left_update_ : last_right_update_;
+
+    odometry_value.timestamp = toTimestamp(last_update_);
+
+    
+    OdometryValue t;
+    odom_queue_.pop(t);
+
+    return true;
+}
+
+template <typename LeftEncoder, typename RightEncoder>
+bool BasicFarmwiseOdometryWheels<LeftEncoder, RightEncoder>::updateResampledOdometry(OdometryValue& odometry_value) {
+    if (left_history_.empty() || right_history_.empty()) {
+        return false;
+    }
+
+    // Start the grid on the first tick covered by both wheels. This also skips
+    // the ticks whose samples were already overwritten by a long lagging stream.
+    std::chrono::steady_clock::time_point first_covered = 
+        std::max(left_history_.oldest().time, right_history_.oldest().time);
+    if (next_output_ < first_covered) {
+        std::chrono::nanoseconds since_epoch = 
+            std::chrono::duration_cast<std::chrono::nanoseconds>(first_covered.time_since_epoch());
+        next_output_ = std::chrono::steady_clock::time_point() 
+            + ((since_epoch + output_period_ - std::chrono::nanoseconds(1)) / output_period_) * output_period_;
+    }
+
+    // Wait until the lagging wheel reaches the grid tick
+    if (next_output_ > left_history_.latest().time || next_output_ > right_history_.latest().time) {
+        return false;
+    }
+
+    odometry_value.speed = 
+        (left_history_.interpolate(next_output_) + right_history_.interpolate(next_output_)) / 2.0;
+    odometry_value.timestamp = toTimestamp(next_output_);
+    next_output_ += output_period_;
+
+    return true;
+}
+
+template <typename LeftEncoder, typename RightEncoder>
+Timestamp BasicFarmwiseOdometryWheels<LeftEncoder, RightEncoder>::toTimestamp(std::chrono::steady_clock::time_point time) {
+    Timestamp timestamp;
+    timestamp.secs = 
+        std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count();
+    timestamp.nsecs = 
+        std::chrono::nanoseconds(time.time_since_epoch()).count() % 1000000000;
+
+    return timestamp;
+}
+
+template <typename LeftEncoder, typename RightEncoder>
+void BasicFarmwiseOdometryWheels<LeftEncoder, RightEncoder>::processLeftEncoder(const EncoderValue& encoder_value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::chrono::steady_clock::time_point current_time = std::chrono::steady_clock::time_point() 
+            + std::chrono::seconds(encoder_value.timestamp.secs) 
+            + std::chrono::nanoseconds(encoder_value.timestamp.nsecs);
+
+    // A restored tick is only unwrapped against updates close enough to the snapshot
+    bool is_restored = left_restored_;
+    bool is_stale_restore = is_restored && (current_time <= last_left_update_
+        || current_time - last_left_update_ > max_restore_gap_periods * LeftEncoder::nominal_period);
+    left_restored_ = false;
+
+    // A duplicated or reordered update carries no new travel, the state is kept
+    if (!is_restored && last_left_update_ != std::chrono::steady_clock::time_point::min()
+        && current_time <= last_left_update_) {
+        return;
+    }
+
+    // If it's the first read, or older than a restored snapshot, or too long after it
+    if (last_left_update_ == std::chrono::steady_clock::time_point::min() || is_stale_restore) {
+        last_left_tick_ = encoder_value.tick;
+        last_left_update_ = current_time;
+        has_left_speed_ = false;
+        left_history_.clear();
+        next_output_ = std::chrono::steady_clock::time_point::min();
+
+        return;
+    }
+
+    // Calculate the tick difference, unwrapping overflow/underflow of the encoder tick
+    int64_t tick_diff = LeftEncoder::tickDelta(encoder_value.tick, last_left_tick_);
+
+    // Calculate the time difference since the last update
+    float elapsed = std::chrono::duration<float>(current_time - last_left_update_).count();
+
+    // Calculate the speed of the left wheel
+    left_speed_ = static_cast<float>(tick_diff) / (ticks_per_meter_ * elapsed);
+    has_left_speed_ = true;
+    left_history_.push(current_time, left_speed_);
+
+    // Update the last tick and update time
+    last_left_tick_ = encoder_value.tick;
+    last_left_update_ = current_time;
+}
+
+template <typename LeftEncoder, typename RightEncoder>
+void BasicFarmwiseOdometryWheels<LeftEncoder, RightEncoder>::processRightEncoder(const EncoderValue& encoder_value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::chrono::steady_clock::time_point current_time = 
+        std::chrono::steady_clock::time_point() 
+        + std::chrono::seconds(encoder_value.timestamp.secs) 
+        + std::chrono::nanoseconds(encoder_value.timestamp.nsecs);
+
+    // A restored tick is only unwrapped against updates close enough to the snapshot
+    bool is_restored = right_restored_;
+    bool is_stale_restore = is_restored && (current_time <= last_right_update_
+        || current_time - last_right_update_ > max_restore_gap_periods * RightEncoder::nominal_period);
+    right_restored_ = false;
+
+    // A duplicated or reordered update carries no new travel, the state is kept
+    if (!is_restored && last_right_update_ != std::chrono::steady_clock::time_point::min()
+        && current_time <= last_right_update_) {
+        return;
+    }
+
+    // If it's the first read, or older than a restored snapshot, or too long after it
+    if (last_right_update_ == std::chrono::steady_clock::time_point::min() || is_stale_restore) {
+        last_right_tick_ = encoder_value.tick;
+        last_right_update_ = current_time;
+        has_right_speed_ = false;
+        right_history_.clear();
+        next_output_ = std::chrono::steady_clock::time_point::min();
+
+        return;
+    }
+
+    // Calculate the tick difference, unwrapping overflow/underflow of the encoder tick
+    int64_t tick_diff = RightEncoder::tickDelta(encoder_value.tick, last_right_tick_);
+
+    // Calculate the time difference since the last update
+    float elapsed = std::chrono::duration<float>(current_time - last_right_update_).count();
+
+    // Calculate the speed of the right wheel
+    right_speed_ = static_cast<float>(tick_diff) / (ticks_per_meter_ * elapsed);
+    has_right_speed_ = true;
+    right_history_.push(current_time, right_speed_);
+
+    // Update the last tick and update time
+    last_right_tick_ = encoder_value.tick;
+    last_right_update_ = current_time;
+}
+
+}  // namespace farmwise_odometry
@@ -0,0 +1,95 @@
+#include "odometry_batch.h"
+#include "synthetic_drive_cycle.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+#define TICKS_PER_METER 10000
+
+// Ten minutes of driving per log.
+#define SAMPLES_PER_LOG 30000
+
+using farmwise_odometry::ArchiveWriter;
+using farmwise_odometry::BatchOptions;
+using farmwise_odometry::EncoderValue;
+using farmwise_odometry::LogSummary;
+
+int main(int argc, char** argv)
+{
+    size_t log_count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 256;
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    unsigned max_threads = argc > 2 ? std::atoi(argv[2]) : cores;
+
+    // Logs are kept in memory so the benchmark measures replay, not storage.
+    std::vector<std::string> logs(log_count);
+    uint64_t samples = 0;
+    for (size_t i = 0; i < log_count; i++)
+    {
+        farmwise_odometry::SyntheticDriveCycle drive_cycle(TICKS_PER_METER, i + 1);
+        std::ostringstream archive;
+        {
+            ArchiveWriter writer(archive);
+            EncoderValue left, right;
+            bool has_left, has_right;
+            for (size_t j = 0; j < SAMPLES_PER_LOG; j++)
+            {
+                drive_cycle.next(left, has_left, right, has_right);
+                if (has_left)
+                {
+                    writer.append(left, true);
+                    samples++;
+                }
+                if (has_right)
+                {
+                    writer.append(right, false);
+                    samples++;
+                }
+            }
+        }
+        logs[i] = archive.str();
+    }
+
+    // Speedups past the core count measure time slicing, not scaling.
+    std::cout << log_count << " logs, " << samples << " encoder samples, " << cores << " hardware threads" << std::endl
+        << "threads,seconds,samples_per_second,speedup,efficiency,oversubscribed" << std::endl;
+    if (cores == 1)
+    {
+        std::cerr << "single hardware thread: scaling cannot be measured on this host" << std::endl;
+    }
+    double single_thread_secs = 0;
+    for (unsigned threads = 1; threads <= max_threads; threads = threads < max_threads ? std::min(2 * threads, max_threads) : threads + 1)
+    {
+        BatchOptions options;
+        options.ticks_per_meter = TICKS_PER_METER;
+        options.threads = threads;
+        std::vector<LogSummary> summaries(log_count);
+
+        auto start = std::chrono::steady_clock::now();
+        farmwise_odometry::parallelFor(log_count, options, [&](size_t i)
+        {
+            std::istringstream in(logs[i]);
+            farmwise_odometry::summarizeLog(in, options, summaries[i]);
+        });
+        double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        for (const LogSummary& summary : summaries)
+        {
+            if (!summary.ok)
+            {
+                std::cerr << "replay failed" << std::endl;
+                return 1;
+            }
+        }
+        if (threads == 1)
+        {
+            single_thread_secs = secs;
+        }
+        double speedup = single_thread_secs / secs;
+        std::cout << threads << ',' << secs << ',' << samples / secs << ','
+            << speedup << ',' << speedup / threads << ',' << (threads > cores) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+#include "odometry_wheels.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#define SAMPLES 16000000
+
+using farmwise_odometry::Encoder16;
+using farmwise_odometry::Encoder24;
+using farmwise_odometry::Encoder32;
+
+// Wraparound as previously handled in processLeftEncoder/processRightEncoder.
+template <typename Encoder>
+__attribute__((noinline)) int64_t sumBranchy(const std::vector<int64_t>& ticks)
+{
+    int64_t sum = 0;
+    for (size_t i = 1; i < ticks.size(); i++)
+    {
+        int64_t tick_diff = ticks[i] - ticks[i - 1];
+        if (tick_diff > Encoder::max_tick / 2)
+        {
+            tick_diff -= Encoder::max_tick + 1;
+        }
+        else if (tick_diff < (-Encoder::max_tick / 2))
+        {
+            tick_diff += Encoder::max_tick + 1;
+        }
+        sum += tick_diff;
+    }
+    return sum;
+}
+
+template <typename Encoder>
+__attribute__((noinline)) int64_t sumBranchless(const std::vector<int64_t>& ticks)
+{
+    int64_t sum = 0;
+    for (size_t i = 1; i < ticks.size(); i++)
+    {
+        sum += Encoder::tickDelta(ticks[i], ticks[i - 1]);
+    }
+    return sum;
+}
+
+// Random walk with a random direction on every sample. max_step bounds the
+// step size; steps close to half the range wrap around on most samples.
+template <typename Encoder>
+std::vector<int64_t> makeTicks(int64_t max_step)
+{
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<int64_t> step(-max_step, max_step);
+    std::vector<int64_t> ticks(SAMPLES);
+    int64_t tick = 0;
+    for (auto& value : ticks)
+    {
+        tick = (tick + step(rng)) & Encoder::max_tick;
+        value = tick;
+    }
+    return ticks;
+}
+
+template <typename Kernel>
+double nanosecondsPerSample(Kernel kernel, const std::vector<int64_t>& ticks, int64_t& sum)
+{
+    double best = 1e9;
+    for (int run = 0; run < 5; run++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        sum = kernel(ticks);
+        best = std::min(best, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best / (ticks.size() - 1);
+}
+
+template <typename Encoder>
+bool bench(const char* name, int64_t max_step)
+{
+    std::vector<int64_t> ticks = makeTicks<Encoder>(max_step);
+    int64_t branchy_sum, branchless_sum;
+    double branchy = nanosecondsPerSample(sumBranchy<Encoder>, ticks, branchy_sum);
+    double branchless = nanosecondsPerSample(sumBranchless<Encoder>, ticks, branchless_sum);
+
+    std::cout << name << ',' << max_step << ',' << branchy << ',' << branchless << ',' << branchy / branchless << std::endl;
+    return branchy_sum == branchless_sum;
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "model,max_step,branchy_ns_per_sample,branchless_ns_per_sample,speedup" << std::endl;
+    bool same = true;
+    same &= bench<Encoder16>("16-bit", 1000);
+    same &= bench<Encoder16>("16-bit", Encoder16::max_tick / 2);
+    same &= bench<Encoder24>("24-bit", 1000);
+    same &= bench<Encoder24>("24-bit", Encoder24::max_tick / 2);
+    same &= bench<Encoder32>("32-bit", 1000);
+    same &= bench<Encoder32>("32-bit", Encoder32::max_tick / 2);
+    if (!same)
+    {
+        std::cerr << "branchy and branchless kernels disagree" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+#include "odometry_archive.h"
+#include "synthetic_drive_cycle.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+#define TICKS_PER_METER 10000
+
+// One shift of a single robot: 3.5 million samples per wheel.
+#define SAMPLES_PER_WHEEL 3500000
+
+using farmwise_odometry::ArchiveReader;
+using farmwise_odometry::ArchiveStream;
+using farmwise_odometry::ArchiveWriter;
+using farmwise_odometry::EncoderValue;
+using farmwise_odometry::OdometryValue;
+
+int main(int argc, char** argv)
+{
+    size_t samples = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : SAMPLES_PER_WHEEL;
+
+    farmwise_odometry::SyntheticDriveCycle drive_cycle(TICKS_PER_METER);
+    std::ostringstream archive;
+    uint64_t encoder_records = 0, odometry_records = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        ArchiveWriter writer(archive);
+        EncoderValue left, right;
+        bool has_left, has_right;
+        for (size_t i = 0; i < samples; i++)
+        {
+            drive_cycle.next(left, has_left, right, has_right);
+            if (has_left)
+            {
+                writer.append(left, true);
+                encoder_records++;
+            }
+            if (has_right)
+            {
+                writer.append(right, false);
+                encoder_records++;
+            }
+            if (has_left && has_right)
+            {
+                writer.append(OdometryValue{drive_cycle.speed(), left.timestamp});
+                odometry_records++;
+            }
+        }
+    }
+    double encode_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::string bytes = archive.str();
+    uint64_t raw_bytes = encoder_records * sizeof(EncoderValue) + odometry_records * sizeof(OdometryValue);
+
+    std::istringstream input(bytes);
+    ArchiveReader reader(input);
+    uint64_t decoded_records = 0;
+    int64_t checksum = 0;
+    start = std::chrono::steady_clock::now();
+    while (reader.nextChunk())
+    {
+        if (reader.stream() == ArchiveStream::Odometry)
+        {
+            decoded_records += reader.odometryValues().size();
+            checksum += reader.odometryValues().back().timestamp.secs;
+        }
+        else
+        {
+            decoded_records += reader.encoderValues().size();
+            checksum += reader.encoderValues().back().tick;
+        }
+    }
+    double decode_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (reader.corrupted() || decoded_records != encoder_records + odometry_records)
+    {
+        std::cerr << "archive round trip failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << "encoder records: " << encoder_records << ", odometry records: " << odometry_records << std::endl
+        << "raw binary: " << raw_bytes << " bytes, archive: " << bytes.size() << " bytes" << std::endl
+        << "compression ratio: " << static_cast<double>(raw_bytes) / bytes.size() << "x"
+        << " (" << 8.0 * bytes.size() / (encoder_records + odometry_records) << " bits/record)" << std::endl
+        << "encode: " << raw_bytes / encode_secs / 1e9 << " GB/s" << std::endl
+        << "decode: " << raw_bytes / decode_secs / 1e9 << " GB/s (checksum " << checksum << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,340 @@
+#include "odometry_archive.h"
+
+#include <cstring>
+
+namespace farmwise_odometry
+{
+namespace
+{
+constexpr uint32_t chunk_magic = 0x4b435746;  // "FWCK" little-endian
+constexpr size_t chunk_header_size = 14;
+constexpr size_t max_varint_size = 10;
+constexpr uint64_t nsecs_per_sec = 1000000000;
+
+inline uint64_t zigzagEncode(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t zigzagDecode(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+inline void putVarint(std::vector<uint8_t>& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+// Returns nullptr if the varint is truncated or longer than 64 bits.
+inline const uint8_t* getVarint(const uint8_t* p, const uint8_t* end, uint64_t& value)
+{
+    // Fast path: one-byte varints dominate smooth logs.
+    if (p < end && *p < 0x80)
+    {
+        value = *p;
+        return p + 1;
+    }
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7)
+    {
+        uint8_t byte = *p++;
+        result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if (byte < 0x80)
+        {
+            value = result;
+            return p;
+        }
+    }
+    return nullptr;
+}
+
+// Shortest signed distance between two ticks of a bits-wide encoder, as EncoderModel::tickDelta.
+inline int64_t unwrapTicks(int64_t tick_delta, int bits)
+{
+    return static_cast<int64_t>(static_cast<uint64_t>(tick_delta) << (64 - bits)) >> (64 - bits);
+}
+
+inline bool isValidEncoderBits(int bits)
+{
+    return bits >= 2 && bits <= 62;
+}
+
+inline uint64_t toNanoseconds(const Timestamp& timestamp)
+{
+    return timestamp.secs * nsecs_per_sec + timestamp.nsecs;
+}
+
+inline Timestamp fromNanoseconds(uint64_t nsecs)
+{
+    Timestamp timestamp;
+    timestamp.secs = static_cast<uint32_t>(nsecs / nsecs_per_sec);
+    timestamp.nsecs = static_cast<uint32_t>(nsecs % nsecs_per_sec);
+    return timestamp;
+}
+
+inline uint32_t floatBits(float value)
+{
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+inline float bitsFloat(uint32_t bits)
+{
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+inline void putU32(uint8_t* out, uint32_t value)
+{
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+    out[2] = static_cast<uint8_t>(value >> 16);
+    out[3] = static_cast<uint8_t>(value >> 24);
+}
+
+inline uint32_t getU32(const uint8_t* in)
+{
+    return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8)
+        | (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+}  // namespace
+
+ArchiveWriter::ArchiveWriter(std::ostream& out, size_t chunk_records, int left_encoder_bits, int right_encoder_bits)
+    : out_(out),
+        chunk_records_(chunk_records > 0 ? chunk_records : 1),
+        bytes_written_(0),
+        left_chunk_{ArchiveStream::LeftEncoder, left_encoder_bits, 0, 0, 0, 0, {}},
+        right_chunk_{ArchiveStream::RightEncoder, right_encoder_bits, 0, 0, 0, 0, {}},
+        odom_chunk_{ArchiveStream::Odometry, 0, 0, 0, 0, 0, {}}
+{
+    // Smooth data averages about two bytes per record.
+    left_chunk_.payload.reserve(chunk_records_ * 3 + 2 * max_varint_size);
+    right_chunk_.payload.reserve(chunk_records_ * 3 + 2 * max_varint_size);
+    odom_chunk_.payload.reserve(chunk_records_ * 4 + 2 * max_varint_size);
+}
+
+ArchiveWriter::~ArchiveWriter()
+{
+    flush();
+}
+
+bool ArchiveWriter::append(const EncoderValue& encoder_value, const bool is_left)
+{
+    ChunkEncoder& chunk = is_left ? left_chunk_ : right_chunk_;
+
+    // Encoder ticks live in [0, 2^bits - 1]; the decoder masks the running sum back into range.
+    if (!isValidEncoderBits(chunk.bits) || encoder_value.tick < 0 || (encoder_value.tick >> chunk.bits) != 0)
+    {
+        return false;
+    }
+    int64_t tick_delta = unwrapTicks(encoder_value.tick - chunk.last_value, chunk.bits);
+    appendRecord(chunk, tick_delta, encoder_value.tick, toNanoseconds(encoder_value.timestamp));
+    return true;
+}
+
+void ArchiveWriter::append(const OdometryValue& odometry_value)
+{
+    int64_t bits = floatBits(odometry_value.speed);
+    appendRecord(odom_chunk_, bits - odom_chunk_.last_value, bits, toNanoseconds(odometry_value.timestamp));
+}
+
+void ArchiveWriter::flush(void)
+{
+    flushChunk(left_chunk_);
+    flushChunk(right_chunk_);
+    flushChunk(odom_chunk_);
+    out_.flush();
+}
+
+void ArchiveWriter::appendRecord(ChunkEncoder& chunk, int64_t value_delta, int64_t value, uint64_t time)
+{
+    putVarint(chunk.payload, zigzagEncode(value_delta));
+
+    // The first record of a chunk carries the absolute timestamp, the following
+    // ones the change in sampling period.
+    if (chunk.count == 0)
+    {
+        putVarint(chunk.payload, time);
+        chunk.last_time_delta = 0;
+    }
+    else
+    {
+        int64_t time_delta = static_cast<int64_t>(time - chunk.last_time);
+        putVarint(chunk.payload, zigzagEncode(time_delta - chunk.last_time_delta));
+        chunk.last_time_delta = time_delta;
+    }
+
+    chunk.last_value = value;
+    chunk.last_time = time;
+    chunk.count++;
+
+    if (chunk.count >= chunk_records_)
+    {
+        flushChunk(chunk);
+    }
+}
+
+void ArchiveWriter::flushChunk(ChunkEncoder& chunk)
+{
+    if (chunk.count == 0)
+    {
+        return;
+    }
+
+    uint8_t header[chunk_header_size];
+    putU32(header, chunk_magic);
+    header[4] = static_cast<uint8_t>(chunk.stream);
+    header[5] = static_cast<uint8_t>(chunk.bits);
+    putU32(header + 6, chunk.count);
+    putU32(header + 10, static_cast<uint32_t>(chunk.payload.size()));
+
+    out_.write(reinterpret_cast<const char*>(header), chunk_header_size);
+    out_.write(reinterpret_cast<const char*>(chunk.payload.data()), chunk.payload.size());
+    bytes_written_ += chunk_header_size + chunk.payload.size();
+
+    // Every chunk decodes on its own, so the delta state restarts from zero.
+    chunk.count = 0;
+    chunk.last_value = 0;
+    chunk.last_time = 0;
+    chunk.last_time_delta = 0;
+    chunk.payload.clear();
+}
+
+ArchiveReader::ArchiveReader(std::istream& in)
+    : in_(in), corrupted_(false), stream_(ArchiveStream::LeftEncoder), encoder_bits_(0)
+{
+}
+
+bool ArchiveReader::nextChunk(void)
+{
+    encoder_values_.clear();
+    odometry_values_.clear();
+    if (corrupted_)
+    {
+        return false;
+    }
+
+    uint8_t header[chunk_header_size];
+    in_.read(reinterpret_cast<char*>(header), chunk_header_size);
+    if (in_.gcount() == 0)
+    {
+        return false;
+    }
+    if (static_cast<size_t>(in_.gcount()) != chunk_header_size || getU32(header) != chunk_magic
+        || header[4] > static_cast<uint8_t>(ArchiveStream::Odometry))
+    {
+        corrupted_ = true;
+        return false;
+    }
+
+    stream_ = static_cast<ArchiveStream>(header[4]);
+    encoder_bits_ = header[5];
+    uint32_t count = getU32(header + 6);
+    uint32_t payload_size = getU32(header + 10);
+
+    // Each record takes between 2 and 2 * max_varint_size bytes.
+    bool valid_bits = stream_ == ArchiveStream::Odometry ? encoder_bits_ == 0 : isValidEncoderBits(encoder_bits_);
+    if (!valid_bits || count == 0 || payload_size < 2 * uint64_t(count) || payload_size > 2 * max_varint_size * uint64_t(count))
+    {
+        corrupted_ = true;
+        return false;
+    }
+
+    payload_.resize(payload_size);
+    in_.read(reinterpret_cast<char*>(payload_.data()), payload_size);
+    if (static_cast<size_t>(in_.gcount()) != payload_size)
+    {
+        corrupted_ = true;
+        return false;
+    }
+
+    const uint8_t* data = payload_.data();
+    const uint8_t* end = data + payload_size;
+    bool decoded = stream_ == ArchiveStream::Odometry
+        ? decodeOdometryChunk(data, end, count)
+        : decodeEncoderChunk(data, end, count);
+    if (!decoded)
+    {
+        encoder_values_.clear();
+        odometry_values_.clear();
+        corrupted_ = true;
+    }
+    return decoded;
+}
+
+bool ArchiveReader::decodeEncoderChunk(const uint8_t* p, const uint8_t* end, uint32_t count)
+{
+    encoder_values_.resize(count);
+    EncoderValue* out = encoder_values_.data();
+    const int64_t max_tick = (int64_t(1) << encoder_bits_) - 1;
+
+    int64_t tick = 0;
+    uint64_t time = 0;
+    int64_t time_delta = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint64_t tick_field, time_field;
+        if (!(p = getVarint(p, end, tick_field)) || !(p = getVarint(p, end, time_field)))
+        {
+            return false;
+        }
+
+        tick = (tick + zigzagDecode(tick_field)) & max_tick;
+        if (i == 0)
+        {
+            time = time_field;
+        }
+        else
+        {
+            time_delta += zigzagDecode(time_field);
+            time += time_delta;
+        }
+
+        out[i].tick = tick;
+        out[i].timestamp = fromNanoseconds(time);
+    }
+    return p == end;
+}
+
+bool ArchiveReader::decodeOdometryChunk(const uint8_t* p, const uint8_t* end, uint32_t count)
+{
+    odometry_values_.resize(count);
+    OdometryValue* out = odometry_values_.data();
+
+    int64_t bits = 0;
+    uint64_t time = 0;
+    int64_t time_delta = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint64_t bits_field, time_field;
+        if (!(p = getVarint(p, end, bits_field)) || !(p = getVarint(p, end, time_field)))
+        {
+            return false;
+        }
+
+        bits += zigzagDecode(bits_field);
+        if (i == 0)
+        {
+            time = time_field;
+        }
+        else
+        {
+            time_delta += zigzagDecode(time_field);
+            time += time_delta;
+        }
+
+        out[i].speed = bitsFloat(static_cast<uint32_t>(bits));
+        out[i].timestamp = fromNanoseconds(time);
+    }
+    return p == end;
+}
+
+}  // namespace farmwise_odometry
@@ -0,0 +1,249 @@
+#include "odometry_batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <thread>
+
+namespace farmwise_odometry
+{
+namespace
+{
+inline int64_t toNanoseconds(const Timestamp& timestamp)
+{
+    return timestamp.secs * int64_t(1000000000) + timestamp.nsecs;
+}
+
+class LogReplay
+{
+public:
+    LogReplay(const BatchOptions& options, LogSummary& summary)
+        : odometry_wheels_(options.ticks_per_meter),
+            encoder_period_(options.encoder_period.count()),
+            summary_(summary),
+            last_left_time_(-1), last_right_time_(-1),
+            first_paired_time_(-1), last_output_time_(-1),
+            speed_mean_(0), speed_m2_(0),
+            left_next_(0), right_next_(0), max_chunk_samples_(0)
+    {
+    }
+
+    void addSamples(const std::vector<EncoderValue>& encoder_values, const bool is_left)
+    {
+        std::vector<EncoderValue>& samples = is_left ? left_samples_ : right_samples_;
+        int64_t& last_time = is_left ? last_left_time_ : last_right_time_;
+        uint64_t& dropped_samples = is_left ? summary_.dropped_left_samples : summary_.dropped_right_samples;
+
+        for (const EncoderValue& encoder_value : encoder_values)
+        {
+            int64_t time = toNanoseconds(encoder_value.timestamp);
+            int64_t gap = time - last_time;
+            if (last_time >= 0 && 2 * gap > 3 * encoder_period_)
+            {
+                dropped_samples += (gap + encoder_period_ / 2) / encoder_period_ - 1;
+            }
+            last_time = time;
+            samples.push_back(encoder_value);
+        }
+        (is_left ? summary_.left_samples : summary_.right_samples) += encoder_values.size();
+        max_chunk_samples_ = std::max(max_chunk_samples_, encoder_values.size());
+    }
+
+    /**
+     * Processes the samples that can be ordered against the other stream,
+     * or every sample once the whole archive was read. A wheel buffers at most
+     * two chunks ahead of a silent other wheel: beyond that, its samples are
+     * processed unpaired, and so are the late samples of the other wheel.
+     */
+    void replay(const bool end_of_log)
+    {
+        while (true)
+        {
+            size_t left_count = left_samples_.size() - left_next_;
+            size_t right_count = right_samples_.size() - right_next_;
+            bool drain = end_of_log || left_count > 2 * max_chunk_samples_ || right_count > 2 * max_chunk_samples_;
+            if (!(left_count && right_count) && !(drain && (left_count || right_count)))
+            {
+                break;
+            }
+
+            const EncoderValue* left = left_count ? &left_samples_[left_next_] : nullptr;
+            const EncoderValue* right = right_count ? &right_samples_[right_next_] : nullptr;
+            int64_t left_time = left ? toNanoseconds(left->timestamp) : INT64_MAX;
+            int64_t right_time = right ? toNanoseconds(right->timestamp) : INT64_MAX;
+
+            if (left_time < right_time)
+            {
+                odometry_wheels_.processLeftEncoder(*left);
+                left_next_++;
+                summary_.unpaired_samples++;
+            }
+            else if (right_time < left_time)
+            {
+                odometry_wheels_.processRightEncoder(*right);
+                right_next_++;
+                summary_.unpaired_samples++;
+            }
+            else
+            {
+                odometry_wheels_.processLeftEncoder(*left);
+                odometry_wheels_.processRightEncoder(*right);
+                left_next_++;
+                right_next_++;
+                summary_.paired_samples++;
+                processPair(left_time);
+            }
+        }
+
+        // Keep the buffers, and their capacity, for the next chunks
+        left_samples_.erase(left_samples_.begin(), left_samples_.begin() + left_next_);
+        right_samples_.erase(right_samples_.begin(), right_samples_.begin() + right_next_);
+        left_next_ = 0;
+        right_next_ = 0;
+    }
+
+    void finish(void)
+    {
+        if (summary_.odometry_updates > 0)
+        {
+            summary_.mean_speed = speed_mean_;
+            summary_.stddev_speed = std::sqrt(speed_m2_ / summary_.odometry_updates);
+        }
+    }
+
+private:
+    void processPair(int64_t time)
+    {
+        if (first_paired_time_ < 0)
+        {
+            first_paired_time_ = time;
+            last_output_time_ = time;
+        }
+        summary_.duration = (time - first_paired_time_) * 1e-9;
+
+        OdometryValue odometry_value;
+        if (!odometry_wheels_.updateOdometry(odometry_value))
+        {
+            return;
+        }
+
+        // Each speed is the average since the previous sample of its wheel
+        float speed = odometry_value.speed;
+        int64_t output_time = toNanoseconds(odometry_value.timestamp);
+        summary_.distance += speed * ((output_time - last_output_time_) * 1e-9);
+        last_output_time_ = output_time;
+
+        summary_.min_speed = summary_.odometry_updates == 0 ? speed : std::min(summary_.min_speed, speed);
+        summary_.max_speed = summary_.odometry_updates == 0 ? speed : std::max(summary_.max_speed, speed);
+        summary_.odometry_updates++;
+
+        // Welford's online variance
+        double delta = speed - speed_mean_;
+        speed_mean_ += delta / summary_.odometry_updates;
+        speed_m2_ += delta * (speed - speed_mean_);
+    }
+
+    FarmwiseOdometryWheels odometry_wheels_;
+    int64_t encoder_period_;
+    LogSummary& summary_;
+    int64_t last_left_time_, last_right_time_;
+    int64_t first_paired_time_, last_output_time_;
+    double speed_mean_, speed_m2_;
+    std::vector<EncoderValue> left_samples_, right_samples_;  // Samples waiting for the other wheel
+    size_t left_next_, right_next_;     // First unprocessed sample of each buffer
+    size_t max_chunk_samples_;          // Largest encoder chunk read so far
+};
+}  // namespace
+
+bool summarizeLog(std::istream& in, const BatchOptions& options, LogSummary& summary)
+{
+    LogReplay log_replay(options, summary);
+    ArchiveReader reader(in);
+    bool supported = true;
+    while (reader.nextChunk())
+    {
+        if (reader.stream() == ArchiveStream::Odometry)
+        {
+            continue;
+        }
+        // FarmwiseOdometryWheels would unwrap other resolutions at the wrong range
+        if (reader.encoderBits() != Encoder24::bits)
+        {
+            supported = false;
+            break;
+        }
+        log_replay.addSamples(reader.encoderValues(), reader.stream() == ArchiveStream::LeftEncoder);
+        log_replay.replay(false);
+    }
+    log_replay.replay(true);
+    log_replay.finish();
+
+    summary.ok = supported && !reader.corrupted();
+    return summary.ok;
+}
+
+void parallelFor(size_t count, const BatchOptions& options, const std::function<void(size_t)>& job)
+{
+    size_t chunk = std::max<size_t>(options.chunk_logs, 1);
+    size_t threads = options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, (count + chunk - 1) / chunk);
+
+    std::atomic<size_t> next_index(0);
+    auto worker = [&]()
+    {
+        for (size_t begin = next_index.fetch_add(chunk); begin < count; begin = next_index.fetch_add(chunk))
+        {
+            for (size_t i = begin; i < std::min(begin + chunk, count); i++)
+            {
+                job(i);
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threads; i++)
+    {
+        workers.push_back(std::thread(worker));
+    }
+    worker();
+    for (auto& thread : workers)
+    {
+        thread.join();
+    }
+}
+
+std::vector<LogSummary> summarizeLogs(const std::vector<std::string>& paths, const BatchOptions& options)
+{
+    std::vector<LogSummary> summaries(paths.size());
+    parallelFor(paths.size(), options, [&](size_t i)
+    {
+        summaries[i].path = paths[i];
+        std::ifstream in(paths[i], std::ios::binary);
+        if (in)
+        {
+            summarizeLog(in, options, summaries[i]);
+        }
+    });
+    return summaries;
+}
+
+void writeSummaries(std::ostream& out, const std::vector<LogSummary>& summaries)
+{
+    out << "path,ok,left_samples,right_samples,paired_samples,unpaired_samples,"
+        << "dropped_left_samples,dropped_right_samples,odometry_updates,duration_s,distance_m,"
+        << "mean_speed_mps,stddev_speed_mps,min_speed_mps,max_speed_mps\n";
+    for (const LogSummary& summary : summaries)
+    {
+        out << summary.path << ',' << summary.ok << ','
+            << summary.left_samples << ',' << summary.right_samples << ','
+            << summary.paired_samples << ',' << summary.unpaired_samples << ','
+            << summary.dropped_left_samples << ',' << summary.dropped_right_samples << ','
+            << summary.odometry_updates << ',' << summary.duration << ',' << summary.distance << ','
+            << summary.mean_speed << ',' << summary.stddev_speed << ','
+            << summary.min_speed << ',' << summary.max_speed << '\n';
+    }
+}
+
+}  // namespace farmwise_odometry
@@ -0,0 +1,108 @@
+#include "odometry_batch.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+using farmwise_odometry::BatchOptions;
+using farmwise_odometry::LogSummary;
+
+void usage(const char* program)
+{
+    std::cerr << "Usage: " << program << " --ticks-per-meter N [options] [log.fwar ...]" << std::endl
+        << "Replays encoder log archives through FarmwiseOdometryWheels and writes one CSV summary line per log." << std::endl
+        << "  --ticks-per-meter N     wheel calibration" << std::endl
+        << "  --encoder-period-ms N   nominal encoder period used to count dropped samples (default 20)" << std::endl
+        << "  --threads N             worker threads (default one per core)" << std::endl
+        << "  --chunk N               logs taken by a worker at a time (default 4)" << std::endl
+        << "  --list FILE             read log paths from FILE, one per line" << std::endl
+        << "  --output FILE           write the summaries to FILE instead of stdout" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    BatchOptions options;
+    std::vector<std::string> paths;
+    const char* output_path = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool has_value = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--ticks-per-meter") && has_value)
+        {
+            options.ticks_per_meter = std::atoi(argv[++i]);
+        }
+        else if (!std::strcmp(argv[i], "--encoder-period-ms") && has_value)
+        {
+            options.encoder_period = std::chrono::milliseconds(std::atoi(argv[++i]));
+        }
+        else if (!std::strcmp(argv[i], "--threads") && has_value)
+        {
+            options.threads = std::atoi(argv[++i]);
+        }
+        else if (!std::strcmp(argv[i], "--chunk") && has_value)
+        {
+            options.chunk_logs = std::atoi(argv[++i]);
+        }
+        else if (!std::strcmp(argv[i], "--list") && has_value)
+        {
+            std::ifstream list(argv[++i]);
+            if (!list)
+            {
+                std::cerr << "cannot read " << argv[i] << std::endl;
+                return 2;
+            }
+            for (std::string path; std::getline(list, path);)
+            {
+                if (!path.empty())
+                {
+                    paths.push_back(path);
+                }
+            }
+        }
+        else if (!std::strcmp(argv[i], "--output") && has_value)
+        {
+            output_path = argv[++i];
+        }
+        else if (argv[i][0] == '-')
+        {
+            usage(argv[0]);
+            return 2;
+        }
+        else
+        {
+            paths.push_back(argv[i]);
+        }
+    }
+    if (options.ticks_per_meter <= 0 || options.encoder_period.count() <= 0 || paths.empty())
+    {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::vector<LogSummary> summaries = farmwise_odometry::summarizeLogs(paths, options);
+
+    std::ofstream output_file;
+    if (output_path)
+    {
+        output_file.open(output_path);
+        if (!output_file)
+        {
+            std::cerr << "cannot write " << output_path << std::endl;
+            return 2;
+        }
+    }
+    farmwise_odometry::writeSummaries(output_path ? output_file : std::cout, summaries);
+
+    int failed = 0;
+    for (const LogSummary& summary : summaries)
+    {
+        if (!summary.ok)
+        {
+            std::cerr << "failed to read " << summary.path << std::endl;
+            failed++;
+        }
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,286 @@
+#include "odometry_snapshot.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+namespace farmwise_odometry
+{
+namespace
+{
+constexpr uint32_t snapshot_magic = 0x4e535746;  // "FWSN" little-endian
+constexpr uint16_t snapshot_version = 3;
+constexpr size_t max_snapshot_size = 4 + 2 + 4 + 2 * 4 + 4 * 8 + 2 * 4 + 8 + 1 + 8 + 2 * (2 + SpeedHistory::capacity * 12) + 4;
+
+// Number of attempts to copy a busy estimator state before waiting for the next period.
+constexpr int snapshot_attempts = 100;
+
+uint32_t fnv1a(const uint8_t* data, size_t size)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+int64_t toNanoseconds(std::chrono::steady_clock::time_point time)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+std::chrono::steady_clock::time_point fromNanoseconds(int64_t nsecs)
+{
+    return std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(nsecs)));
+}
+
+class Encoder
+{
+public:
+    void put(const void* value, size_t size)
+    {
+        // Snapshots are little-endian, like every supported target.
+        const uint8_t* bytes = static_cast<const uint8_t*>(value);
+        buffer_.insert(buffer_.end(), bytes, bytes + size);
+    }
+
+    template <typename T>
+    void put(T value) { put(&value, sizeof(value)); }
+
+    void putTime(std::chrono::steady_clock::time_point time) { put<int64_t>(toNanoseconds(time)); }
+
+    void putEncoderModel(const EncoderModelId& encoder_model)
+    {
+        put<uint8_t>(encoder_model.bits);
+        put<int8_t>(encoder_model.direction);
+        put<uint16_t>(encoder_model.rate_hz);
+    }
+
+    void putHistory(const SpeedHistory& history)
+    {
+        put<uint16_t>(history.size());
+        for (size_t i = 0; i < history.size(); i++)
+        {
+            putTime(history.at(i).time);
+            put<float>(history.at(i).speed);
+        }
+    }
+
+    const std::vector<uint8_t>& buffer(void) const { return buffer_; };
+
+private:
+    std::vector<uint8_t> buffer_;
+};
+
+class Decoder
+{
+public:
+    Decoder(const uint8_t* data, size_t size) : data_(data), end_(data + size) {};
+
+    template <typename T>
+    bool get(T& value)
+    {
+        if (static_cast<size_t>(end_ - data_) < sizeof(value))
+        {
+            return false;
+        }
+        std::memcpy(&value, data_, sizeof(value));
+        data_ += sizeof(value);
+        return true;
+    }
+
+    bool getTime(std::chrono::steady_clock::time_point& time)
+    {
+        int64_t nsecs;
+        if (!get(nsecs))
+        {
+            return false;
+        }
+        time = fromNanoseconds(nsecs);
+        return true;
+    }
+
+    bool getEncoderModel(EncoderModelId& encoder_model)
+    {
+        uint8_t bits;
+        int8_t direction;
+        uint16_t rate_hz;
+        if (!get(bits) || !get(direction) || !get(rate_hz))
+        {
+            return false;
+        }
+        encoder_model = EncoderModelId{bits, direction, rate_hz};
+        return true;
+    }
+
+    bool getHistory(SpeedHistory& history)
+    {
+        uint16_t count;
+        if (!get(count) || count > SpeedHistory::capacity)
+        {
+            return false;
+        }
+        history.clear();
+        for (uint16_t i = 0; i < count; i++)
+        {
+            std::chrono::steady_clock::time_point time;
+            float speed;
+            if (!getTime(time) || !get(speed) || (!history.empty() && time <= history.latest().time))
+            {
+                return false;
+            }
+            history.push(time, speed);
+        }
+        return true;
+    }
+
+    bool done(void) const { return data_ == end_; };
+
+private:
+    const uint8_t* data_;
+    const uint8_t* end_;
+};
+}  // namespace
+
+bool writeSnapshot(std::ostream& out, const OdometrySnapshot& snapshot)
+{
+    Encoder encoder;
+    encoder.put<uint32_t>(snapshot_magic);
+    encoder.put<uint16_t>(snapshot_version);
+    encoder.put<int32_t>(snapshot.ticks_per_meter);
+    encoder.putEncoderModel(snapshot.left_encoder);
+    encoder.putEncoderModel(snapshot.right_encoder);
+    encoder.put<int64_t>(snapshot.last_left_tick);
+    encoder.put<int64_t>(snapshot.last_right_tick);
+    encoder.putTime(snapshot.last_left_update);
+    encoder.putTime(snapshot.last_right_update);
+    encoder.put<float>(snapshot.left_speed);
+    encoder.put<float>(snapshot.right_speed);
+    encoder.putTime(snapshot.last_pair_update);
+    encoder.put<uint8_t>((snapshot.has_left_speed ? 1 : 0) | (snapshot.has_right_speed ? 2 : 0));
+    encoder.putTime(snapshot.next_output);
+    encoder.putHistory(snapshot.left_history);
+    encoder.putHistory(snapshot.right_history);
+    encoder.put<uint32_t>(fnv1a(encoder.buffer().data(), encoder.buffer().size()));
+
+    out.write(reinterpret_cast<const char*>(encoder.buffer().data()), encoder.buffer().size());
+    return static_cast<bool>(out);
+}
+
+bool readSnapshot(std::istream& in, OdometrySnapshot& snapshot)
+{
+    uint8_t buffer[max_snapshot_size + 1];
+    in.read(reinterpret_cast<char*>(buffer), sizeof(buffer));
+    size_t size = in.gcount();
+    if (size < sizeof(uint32_t) || size > max_snapshot_size)
+    {
+        return false;
+    }
+
+    uint32_t checksum;
+    std::memcpy(&checksum, buffer + size - sizeof(checksum), sizeof(checksum));
+    if (checksum != fnv1a(buffer, size - sizeof(checksum)))
+    {
+        return false;
+    }
+
+    Decoder decoder(buffer, size - sizeof(checksum));
+    uint32_t magic;
+    uint16_t version;
+    int32_t ticks_per_meter;
+    uint8_t flags;
+    if (!decoder.get(magic) || magic != snapshot_magic || !decoder.get(version) || version != snapshot_version)
+    {
+        return false;
+    }
+    if (!decoder.get(ticks_per_meter) || !decoder.getEncoderModel(snapshot.left_encoder)
+        || !decoder.getEncoderModel(snapshot.right_encoder)
+        || !decoder.get(snapshot.last_left_tick) || !decoder.get(snapshot.last_right_tick)
+        || !decoder.getTime(snapshot.last_left_update) || !decoder.getTime(snapshot.last_right_update)
+        || !decoder.get(snapshot.left_speed) || !decoder.get(snapshot.right_speed)
+        || !decoder.getTime(snapshot.last_pair_update)
+        || !decoder.get(flags) || !decoder.getTime(snapshot.next_output)
+        || !decoder.getHistory(snapshot.left_history) || !decoder.getHistory(snapshot.right_history))
+    {
+        return false;
+    }
+    snapshot.ticks_per_meter = ticks_per_meter;
+    snapshot.has_left_speed = flags & 1;
+    snapshot.has_right_speed = flags & 2;
+
+    return decoder.done();
+}
+
+bool saveSnapshot(const std::string& path, const OdometrySnapshot& snapshot)
+{
+    std::string temporary_path = path + ".tmp";
+    {
+        std::ofstream out(temporary_path, std::ios::binary | std::ios::trunc);
+        if (!writeSnapshot(out, snapshot))
+        {
+            return false;
+        }
+        out.close();
+        if (!out)
+        {
+            return false;
+        }
+    }
+    return std::rename(temporary_path.c_str(), path.c_str()) == 0;
+}
+
+bool loadSnapshot(const std::string& path, OdometrySnapshot& snapshot)
+{
+    std::ifstream in(path, std::ios::binary);
+    return in && readSnapshot(in, snapshot);
+}
+
+SnapshotWriter::SnapshotWriter(std::function<bool(OdometrySnapshot&)> try_snapshot, const std::string& path,
+                               std::chrono::milliseconds period)
+    : try_snapshot_(std::move(try_snapshot)), path_(path), period_(period), stop_thread_(false),
+        thread_(&SnapshotWriter::callbackSnapshot, this)
+{
+}
+
+SnapshotWriter::~SnapshotWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_thread_ = true;
+    }
+    stop_condition_.notify_one();
+    thread_.join();
+    checkpoint();
+}
+
+void SnapshotWriter::callbackSnapshot(void)
+{
+    std::chrono::steady_clock::time_point next_checkpoint = std::chrono::steady_clock::now() + period_;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_condition_.wait_until(lock, next_checkpoint, [this] { return stop_thread_; }))
+    {
+        lock.unlock();
+        checkpoint();
+        lock.lock();
+        next_checkpoint += period_;
+    }
+}
+
+bool SnapshotWriter::checkpoint(void)
+{
+    for (int attempt = 0; attempt < snapshot_attempts; attempt++)
+    {
+        if (try_snapshot_(snapshot_))
+        {
+            return saveSnapshot(path_, snapshot_);
+        }
+        std::this_thread::yield();
+    }
+    return false;
+}
+
+}  // namespace farmwise_odometry
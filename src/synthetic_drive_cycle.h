@@ -0,0 +1,111 @@
+/**********************************************
+ * @file synthetic_drive_cycle.h
+ * @brief Deterministic synthetic drive cycle used by the
+ * benchmarks to produce realistic encoder streams.
+ **********************************************/
+
+#pragma once
+
+#include "odometry_wheels.h"
+
+#include <cstdint>
+
+namespace farmwise_odometry
+{
+
+/**
+ * Repeats a two minute cycle of idle, acceleration, cruise, turn, braking and
+ * reversing at 50 Hz. Wheel speeds carry a small deterministic noise and a
+ * fraction of the samples of each wheel is dropped, as seen on the CAN bus.
+ */
+class SyntheticDriveCycle
+{
+public:
+    static constexpr uint32_t period_nsecs = 20000000;
+
+    SyntheticDriveCycle(int ticks_per_meter, uint32_t seed = 1, uint32_t drop_per_mille = 1)
+        : ticks_per_meter_(ticks_per_meter),
+            drop_per_mille_(drop_per_mille),
+            rng_(seed ? seed : 1),
+            sample_(0),
+            left_position_(0), right_position_(0),
+            left_speed_(0), right_speed_(0)
+    {
+    }
+
+    /**
+     * Advances the cycle by one period.
+     * @return for each wheel, false if its sample was dropped.
+     */
+    void next(EncoderValue& left, bool& has_left, EncoderValue& right, bool& has_right)
+    {
+        double t = (sample_ % cycle_samples) * (period_nsecs * 1e-9);
+        double center = centerSpeed(t);
+        double turn = (t >= 55.0 && t < 70.0) ? 0.3 : 0.0;
+
+        left_speed_ = static_cast<float>((center - turn) * (1.0 + noise() * 0.01));
+        right_speed_ = static_cast<float>((center + turn) * (1.0 + noise() * 0.01));
+        left_position_ += left_speed_ * ticks_per_meter_ * (period_nsecs * 1e-9);
+        right_position_ += right_speed_ * ticks_per_meter_ * (period_nsecs * 1e-9);
+
+        uint64_t nsecs = sample_ * uint64_t(period_nsecs);
+        Timestamp timestamp{static_cast<uint32_t>(nsecs / 1000000000), static_cast<uint32_t>(nsecs % 1000000000)};
+        left.tick = wrapTick(left_position_);
+        left.timestamp = timestamp;
+        right.tick = wrapTick(right_position_);
+        right.timestamp = timestamp;
+
+        has_left = (nextRandom() % 1000) >= drop_per_mille_;
+        has_right = (nextRandom() % 1000) >= drop_per_mille_;
+        sample_++;
+    }
+
+    /**
+     * @return the true speed at the center of the wheels for the last period.
+     */
+    float speed(void) const { return (left_speed_ + right_speed_) / 2; };
+
+private:
+    static constexpr uint64_t cycle_samples = 120 * 50;
+
+    static double centerSpeed(double t)
+    {
+        if (t < 5.0) return 0.0;                             // idle
+        if (t < 10.0) return 1.5 * (t - 5.0) / 5.0;          // accelerate
+        if (t < 80.0) return 1.5;                            // cruise and turn
+        if (t < 85.0) return 1.5 * (85.0 - t) / 5.0;         // brake
+        if (t < 90.0) return 0.0;                            // stop
+        if (t < 95.0) return -0.5 * (t - 90.0) / 5.0;        // reverse
+        if (t < 110.0) return -0.5;
+        if (t < 115.0) return -0.5 * (115.0 - t) / 5.0;
+        return 0.0;
+    }
+
+    int64_t wrapTick(double position) const
+    {
+        return static_cast<int64_t>(position) & EncoderValue::max_tick;
+    }
+
+    uint32_t nextRandom(void)
+    {
+        // xorshift32
+        rng_ ^= rng_ << 13;
+        rng_ ^= rng_ >> 17;
+        rng_ ^= rng_ << 5;
+        return rng_;
+    }
+
+    // Uniform in [-1, 1].
+    double noise(void)
+    {
+        return nextRandom() / 2147483647.5 - 1.0;
+    }
+
+    int ticks_per_meter_;
+    uint32_t drop_per_mille_;
+    uint32_t rng_;
+    uint64_t sample_;
+    double left_position_, right_position_;
+    float left_speed_, right_speed_;
+};
+}  // namespace farmwise_odometry
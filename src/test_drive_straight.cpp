@@ -1,4 +1,5 @@
 #include "odometry_wheels.h"
+#include "test_helpers.h"
 #include <cassert>
 #include <memory>
 #include <iostream>
@@ -9,6 +10,9 @@ farmwise_odometry::OdometryValue odometry_value;
 std::shared_ptr<farmwise_odometry::FarmwiseOdometryWheels> odometry_wheels;
 
 #define TICKS_PER_METER 300
+#define FLOAT_TOLERANCE 1e-6
+
+using farmwise_odometry::is_same_float;
 
 void start()
 {
@@ -16,11 +20,6 @@ void start()
     odometry_wheels->start();
 }
 
-bool is_same_float(float float1, float float2)
-{
-    return (std::abs(float1 - float2) < 1e-6);
-}
-
 // Test one value pair, no speed available
 void test_1()
 {
@@ -57,9 +56,8 @@ void test_2()
             continue;
         }
 
-        std::cout << "[test_2] odom_queue_ is empty: " << odometry_wheels->odom_queue_.empty() << std::endl;
         assert(odometry_wheels->getOdometryUpdate(odometry_value));
-        assert(is_same_float(odometry_value.speed, 1 / static_cast<float>(TICKS_PER_METER)));
+        assert(is_same_float(odometry_value.speed, 1 / static_cast<float>(TICKS_PER_METER), FLOAT_TOLERANCE));
     }
     // assert(!odometry_wheels->getOdometryUpdate(odometry_value));
 }
@@ -87,7 +85,7 @@ void test_3()
             << ", i / static_cast<float>(TICKS_PER_METER): " << i / static_cast<float>(TICKS_PER_METER)
             << std::endl;
 
-        assert(is_same_float(odometry_value.speed, i / static_cast<float>(TICKS_PER_METER)));
+        assert(is_same_float(odometry_value.speed, i / static_cast<float>(TICKS_PER_METER), FLOAT_TOLERANCE));
     }
     assert(!odometry_wheels->getOdometryUpdate(odometry_value));
 }
@@ -110,7 +108,7 @@ void test_4()
             continue;
         }
         assert(odometry_wheels->getOdometryUpdate(odometry_value));
-        assert(is_same_float(odometry_value.speed, -1 / static_cast<float>(TICKS_PER_METER)));
+        assert(is_same_float(odometry_value.speed, -1 / static_cast<float>(TICKS_PER_METER), FLOAT_TOLERANCE));
     }
     assert(!odometry_wheels->getOdometryUpdate(odometry_value));
 }
@@ -142,7 +140,7 @@ void test_5()
             continue;
         }
         assert(odometry_wheels->getOdometryUpdate(odometry_value));
-        assert(is_same_float(odometry_value.speed, 1 / static_cast<float>(TICKS_PER_METER)));
+        assert(is_same_float(odometry_value.speed, 1 / static_cast<float>(TICKS_PER_METER), FLOAT_TOLERANCE));
     }
     assert(!odometry_wheels->getOdometryUpdate(odometry_value));
 }
@@ -177,7 +175,7 @@ void test_6()
             odometry_wheels->newEncoderUpdate(encoder_value, false);
             usleep(1e5);
             assert(odometry_wheels->getOdometryUpdate(odometry_value));
-            assert(is_same_float(odometry_value.speed, 1 / static_cast<float>(TICKS_PER_METER)));
+            assert(is_same_float(odometry_value.speed, 1 / static_cast<float>(TICKS_PER_METER), FLOAT_TOLERANCE));
         }
     }
     assert(!odometry_wheels->getOdometryUpdate(odometry_value));
@@ -221,7 +219,7 @@ void test_7()
             odometry_wheels->newEncoderUpdate(encoder_value, false);
             usleep(1e5);
             assert(odometry_wheels->getOdometryUpdate(odometry_value));
-            assert(is_same_float(odometry_value.speed, i / static_cast<float>(TICKS_PER_METER) / 2.0));
+            assert(is_same_float(odometry_value.speed, i / static_cast<float>(TICKS_PER_METER) / 2.0, FLOAT_TOLERANCE));
         }
     }
     assert(!odometry_wheels->getOdometryUpdate(odometry_value));
@@ -266,7 +264,7 @@ void test_8()
             odometry_wheels->newEncoderUpdate(encoder_value, false);
             usleep(1e5);
             assert(odometry_wheels->getOdometryUpdate(odometry_value));
-            assert(is_same_float(odometry_value.speed, i / static_cast<float>(TICKS_PER_METER) / 2.5));
+            assert(is_same_float(odometry_value.speed, i / static_cast<float>(TICKS_PER_METER) / 2.5, FLOAT_TOLERANCE));
         }
     }
     assert(!odometry_wheels->getOdometryUpdate(odometry_value));
@@ -293,7 +291,7 @@ void test_9()
         if (i % 2 == 0)
         {
             assert(odometry_wheels->getOdometryUpdate(odometry_value));
-            assert(is_same_float(odometry_value.speed, i / static_cast<float>(TICKS_PER_METER)));
+            assert(is_same_float(odometry_value.speed, i / static_cast<float>(TICKS_PER_METER), FLOAT_TOLERANCE));
         }
     }
     // i == 9 was not read
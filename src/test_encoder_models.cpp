@@ -0,0 +1,128 @@
+#include "odometry_wheels.h"
+#include "test_helpers.h"
+#include <cassert>
+#include <iostream>
+#include <random>
+
+#define TICKS_PER_METER 300
+#define ENCODER_PERIOD_NSECS 20000000
+
+using farmwise_odometry::BasicFarmwiseOdometryWheels;
+using farmwise_odometry::Encoder16;
+using farmwise_odometry::Encoder24;
+using farmwise_odometry::Encoder32;
+using farmwise_odometry::EncoderModel;
+using farmwise_odometry::EncoderValue;
+using farmwise_odometry::OdometryValue;
+using farmwise_odometry::is_same_float;
+using farmwise_odometry::make_encoder_value;
+
+// Branch-free unwrap matches the two-branch unwrap away from the half-range ambiguity
+template <typename Encoder>
+void check_tick_delta()
+{
+    std::mt19937_64 rng(7);
+    std::uniform_int_distribution<int64_t> tick(0, Encoder::max_tick);
+    for (int i = 0; i < 100000; i++)
+    {
+        int64_t current = tick(rng), last = tick(rng);
+        int64_t tick_diff = current - last;
+        if (tick_diff > Encoder::max_tick / 2)
+        {
+            tick_diff -= Encoder::max_tick + 1;
+        }
+        else if (tick_diff < (-Encoder::max_tick / 2))
+        {
+            tick_diff += Encoder::max_tick + 1;
+        }
+        assert(std::abs(tick_diff) == (Encoder::max_tick + 1) / 2 || Encoder::tickDelta(current, last) == tick_diff);
+    }
+}
+
+void test_1()
+{
+    check_tick_delta<Encoder16>();
+    check_tick_delta<Encoder24>();
+    check_tick_delta<Encoder32>();
+}
+
+// Mixed-resolution pair, both wheels overflowing then underflowing at their own range
+template <typename LeftEncoder, typename RightEncoder>
+void check_mixed_pair()
+{
+    BasicFarmwiseOdometryWheels<LeftEncoder, RightEncoder> odometry_wheels(TICKS_PER_METER);
+    OdometryValue odometry_value{};
+    int64_t position = 30;
+    for (uint64_t i = 0; i < 20; i++)
+    {
+        int64_t step = i < 10 ? -6 : 12;
+        position += i ? step : 0;
+        odometry_wheels.processLeftEncoder(make_encoder_value(position, i * ENCODER_PERIOD_NSECS, LeftEncoder::max_tick));
+        odometry_wheels.processRightEncoder(make_encoder_value(position, i * ENCODER_PERIOD_NSECS, RightEncoder::max_tick));
+        if (i == 0)
+        {
+            assert(!odometry_wheels.updateOdometry(odometry_value));
+            continue;
+        }
+        assert(odometry_wheels.updateOdometry(odometry_value));
+        assert(is_same_float(odometry_value.speed, step / (TICKS_PER_METER * 0.02f)));
+    }
+}
+
+void test_2()
+{
+    check_mixed_pair<Encoder16, Encoder32>();
+    check_mixed_pair<Encoder32, Encoder24>();
+    check_mixed_pair<Encoder24, Encoder16>();
+}
+
+// Left encoder mounted mirrored, counting down through its underflow while driving forward
+void test_3()
+{
+    using ReversedEncoder16 = EncoderModel<16, -1>;
+    BasicFarmwiseOdometryWheels<ReversedEncoder16, Encoder24> odometry_wheels(TICKS_PER_METER);
+    OdometryValue odometry_value{};
+    int64_t position = 0;
+    for (uint64_t i = 0; i < 20; i++)
+    {
+        position += i ? 9 : 0;
+        odometry_wheels.processLeftEncoder(make_encoder_value(40 - position, i * ENCODER_PERIOD_NSECS, ReversedEncoder16::max_tick));
+        odometry_wheels.processRightEncoder(make_encoder_value(position, i * ENCODER_PERIOD_NSECS));
+        if (i == 0)
+        {
+            assert(!odometry_wheels.updateOdometry(odometry_value));
+            continue;
+        }
+        assert(odometry_wheels.updateOdometry(odometry_value));
+        assert(is_same_float(odometry_value.speed, 9 / (TICKS_PER_METER * 0.02f)));
+    }
+}
+
+// 100 Hz encoders, resampled on their own nominal period
+void test_4()
+{
+    using FastEncoder24 = EncoderModel<24, 1, 100>;
+    BasicFarmwiseOdometryWheels<FastEncoder24> odometry_wheels(TICKS_PER_METER, FastEncoder24::nominal_period);
+    OdometryValue odometry_value{};
+    uint64_t period_nsecs = FastEncoder24::nominal_period.count();
+    int outputs = 0;
+    for (uint64_t i = 0; i < 20; i++)
+    {
+        odometry_wheels.processLeftEncoder(make_encoder_value(i * 3, i * period_nsecs));
+        odometry_wheels.processRightEncoder(make_encoder_value(i * 3, i * period_nsecs));
+        while (odometry_wheels.updateOdometry(odometry_value))
+        {
+            assert(is_same_float(odometry_value.speed, 3 / (TICKS_PER_METER * 0.01f)));
+            outputs++;
+        }
+    }
+    assert(outputs == 19);
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "Test 1 "; test_1(); std::cout << "✔️" << std::endl;
+    std::cout << "Test 2 "; test_2(); std::cout << "✔️" << std::endl;
+    std::cout << "Test 3 "; test_3(); std::cout << "✔️" << std::endl;
+    std::cout << "Test 4 "; test_4(); std::cout << "✔️" << std::endl;
+}
@@ -0,0 +1,49 @@
+/**********************************************
+ * @file test_helpers.h
+ * @brief Encoder and odometry value helpers shared by
+ * the tests.
+ **********************************************/
+
+#pragma once
+
+#include "odometry_wheels.h"
+
+#include <cmath>
+#include <cstdint>
+
+namespace farmwise_odometry
+{
+
+/**
+ * Encoder value at nsecs since the epoch, with tick wrapped into [0, max_tick].
+ */
+inline EncoderValue make_encoder_value(int64_t tick, uint64_t nsecs, int64_t max_tick = EncoderValue::max_tick)
+{
+    EncoderValue encoder_value;
+    encoder_value.tick = tick & max_tick;
+    encoder_value.timestamp.secs = nsecs / 1000000000;
+    encoder_value.timestamp.nsecs = nsecs % 1000000000;
+    return encoder_value;
+}
+
+/**
+ * Encoder value at timestamp, with tick kept as is.
+ */
+inline EncoderValue make_encoder_value(int64_t tick, const Timestamp& timestamp)
+{
+    EncoderValue encoder_value;
+    encoder_value.tick = tick;
+    encoder_value.timestamp = timestamp;
+    return encoder_value;
+}
+
+inline uint64_t to_nsecs(const OdometryValue& odometry_value)
+{
+    return odometry_value.timestamp.secs * uint64_t(1000000000) + odometry_value.timestamp.nsecs;
+}
+
+inline bool is_same_float(double float1, double float2, double tolerance = 1e-4)
+{
+    return (std::abs(float1 - float2) < tolerance);
+}
+}  // namespace farmwise_odometry
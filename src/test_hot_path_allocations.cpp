@@ -0,0 +1,280 @@
+#include "odometry_wheels.h"
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <unistd.h>
+
+/**
+ * Replaces the global allocation functions to count every allocation made
+ * while the harness is armed, whichever thread makes it. On glibc the C
+ * allocation functions are intercepted as well, which also covers code that
+ * bypasses operator new. Over-aligned allocations, through the align_val_t
+ * forms of operator new or the aligned C functions, are counted too.
+ */
+
+#define TICKS_PER_METER 300
+#define SAMPLES_PER_WHEEL 200000
+
+namespace
+{
+std::atomic<bool> armed(false);
+std::atomic<uint64_t> allocations(0);
+thread_local uint64_t thread_allocations = 0;
+
+inline void record_allocation()
+{
+    if (armed.load(std::memory_order_relaxed))
+    {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        thread_allocations++;
+    }
+}
+}  // namespace
+
+#ifdef __GLIBC__
+extern "C"
+{
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+
+void* malloc(size_t size)
+{
+    record_allocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    record_allocation();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    record_allocation();
+    return __libc_realloc(ptr, size);
+}
+
+void* memalign(size_t alignment, size_t size)
+{
+    record_allocation();
+    return __libc_memalign(alignment, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size)
+{
+    record_allocation();
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size)
+{
+    record_allocation();
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+    {
+        return EINVAL;
+    }
+    void* result = __libc_memalign(alignment, size);
+    if (!result)
+    {
+        return ENOMEM;
+    }
+    *ptr = result;
+    return 0;
+}
+
+void* valloc(size_t size)
+{
+    record_allocation();
+    return __libc_memalign(sysconf(_SC_PAGESIZE), size);
+}
+}
+
+inline void* raw_malloc(size_t size) { return __libc_malloc(size); }
+inline void* raw_aligned_malloc(size_t alignment, size_t size) { return __libc_memalign(alignment, size); }
+#else
+inline void* raw_malloc(size_t size) { return std::malloc(size); }
+inline void* raw_aligned_malloc(size_t alignment, size_t size)
+{
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+#endif
+
+void* operator new(size_t size)
+{
+    record_allocation();
+    void* ptr = raw_malloc(size ? size : 1);
+    if (!ptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    record_allocation();
+    return raw_malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+    record_allocation();
+    void* ptr = raw_aligned_malloc(static_cast<size_t>(alignment), size ? size : 1);
+    if (!ptr)
+    {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    record_allocation();
+    return raw_aligned_malloc(static_cast<size_t>(alignment), size ? size : 1);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, alignment, tag);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { std::free(ptr); }
+
+using farmwise_odometry::EncoderValue;
+using farmwise_odometry::FarmwiseOdometryWheels;
+using farmwise_odometry::OdometryValue;
+
+// Feeds both wheels as fast as the queues accept, reading odometry along the way.
+// Returns the number of odometry updates read.
+uint64_t run_high_rate(FarmwiseOdometryWheels& odometry_wheels)
+{
+    EncoderValue encoder_value;
+    OdometryValue odometry_value;
+    uint64_t updates = 0;
+    for (uint64_t i = 0; i < SAMPLES_PER_WHEEL; i++)
+    {
+        uint64_t nsecs = i * 20000000;
+        encoder_value.timestamp.secs = nsecs / 1000000000;
+        encoder_value.timestamp.nsecs = nsecs % 1000000000;
+        encoder_value.tick = (7 * i) & EncoderValue::max_tick;
+        while (!odometry_wheels.newEncoderUpdate(encoder_value, true))
+        {
+            std::this_thread::yield();
+        }
+        while (!odometry_wheels.newEncoderUpdate(encoder_value, false))
+        {
+            std::this_thread::yield();
+        }
+        while (odometry_wheels.getOdometryUpdate(odometry_value))
+        {
+            updates++;
+        }
+    }
+
+    // Let the internal threads drain the queues and go through their idle paths
+    usleep(1e5);
+    while (odometry_wheels.getOdometryUpdate(odometry_value))
+    {
+        updates++;
+    }
+    return updates;
+}
+
+void run_armed(std::chrono::nanoseconds output_period)
+{
+    std::unique_ptr<FarmwiseOdometryWheels> odometry_wheels(
+        new FarmwiseOdometryWheels(TICKS_PER_METER, output_period));
+    odometry_wheels->start();
+
+    thread_allocations = 0;
+    allocations = 0;
+    armed = true;
+    uint64_t updates = run_high_rate(*odometry_wheels);
+    armed = false;
+
+    std::cout << "(" << updates << " updates, " << allocations << " allocations) ";
+    assert(updates > 0);
+    assert(thread_allocations == 0);
+    assert(allocations == 0);
+}
+
+// Runs allocate with the harness armed, returns the number of allocations seen
+template <typename Allocate>
+uint64_t count_allocations(Allocate allocate)
+{
+    allocations = 0;
+    armed = true;
+    allocate();
+    armed = false;
+    uint64_t count = allocations;
+    allocations = 0;
+    return count;
+}
+
+struct alignas(64) CacheLine
+{
+    char bytes[64];
+};
+
+// The harness catches allocations from any thread, over-aligned ones included
+void test_1()
+{
+    assert(count_allocations([] { std::thread([] { delete new int(1); }).join(); }) > 0);
+    assert(count_allocations([] { CacheLine* volatile line = new CacheLine; delete line; }) == 1);
+    assert(count_allocations([] { CacheLine* volatile lines = new CacheLine[4]; delete[] lines; }) == 1);
+    assert(count_allocations([] { void* volatile ptr = std::aligned_alloc(64, 64); std::free(ptr); }) == 1);
+    assert(count_allocations([]
+    {
+        void* ptr = nullptr;
+        assert(posix_memalign(&ptr, 64, 64) == 0);
+        std::free(ptr);
+    }) == 1);
+}
+
+// Event-driven output allocates nothing after start()
+void test_2()
+{
+    run_armed(std::chrono::nanoseconds::zero());
+}
+
+// Timer-driven resampled output allocates nothing after start()
+void test_3()
+{
+    run_armed(std::chrono::milliseconds(10));
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "Test 1 "; test_1(); std::cout << "✔️" << std::endl;
+    std::cout << "Test 2 "; test_2(); std::cout << "✔️" << std::endl;
+    std::cout << "Test 3 "; test_3(); std::cout << "✔️" << std::endl;
+}
@@ -0,0 +1,171 @@
+#include "odometry_archive.h"
+#include "test_helpers.h"
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+using farmwise_odometry::ArchiveReader;
+using farmwise_odometry::ArchiveStream;
+using farmwise_odometry::ArchiveWriter;
+using farmwise_odometry::EncoderValue;
+using farmwise_odometry::OdometryValue;
+using farmwise_odometry::make_encoder_value;
+
+bool is_same_encoder_value(const EncoderValue& value1, const EncoderValue& value2)
+{
+    return value1.tick == value2.tick && value1.timestamp.secs == value2.timestamp.secs
+        && value1.timestamp.nsecs == value2.timestamp.nsecs;
+}
+
+// Round trip across chunk boundaries, overflowed and underflowed ticks, irregular timestamps
+void test_1()
+{
+    std::vector<EncoderValue> left, right;
+    for (uint32_t i = 0; i < 1000; i++)
+    {
+        left.push_back(make_encoder_value((EncoderValue::max_tick - 500 + 3 * i) % (EncoderValue::max_tick + 1),
+                                          {100 + i / 50, (i % 50) * 20000000}));
+        right.push_back(make_encoder_value((700 - 2 * int64_t(i) + EncoderValue::max_tick + 1) % (EncoderValue::max_tick + 1),
+                                           {100 + i / 7, (i % 7) * 123456789 + (i % 3)}));
+    }
+
+    std::stringstream archive;
+    {
+        ArchiveWriter writer(archive, 64);
+        for (size_t i = 0; i < left.size(); i++)
+        {
+            writer.append(left[i], true);
+            writer.append(right[i], false);
+        }
+    }
+
+    ArchiveReader reader(archive);
+    size_t left_index = 0, right_index = 0;
+    while (reader.nextChunk())
+    {
+        assert(reader.stream() != ArchiveStream::Odometry);
+        std::vector<EncoderValue>& expected = reader.stream() == ArchiveStream::LeftEncoder ? left : right;
+        size_t& index = reader.stream() == ArchiveStream::LeftEncoder ? left_index : right_index;
+        for (const EncoderValue& encoder_value : reader.encoderValues())
+        {
+            assert(is_same_encoder_value(encoder_value, expected[index]));
+            index++;
+        }
+    }
+    assert(!reader.corrupted());
+    assert(left_index == left.size());
+    assert(right_index == right.size());
+}
+
+// Odometry round trip is bit exact
+void test_2()
+{
+    std::vector<OdometryValue> values;
+    for (uint32_t i = 0; i < 300; i++)
+    {
+        values.push_back(OdometryValue{1.5f * i / 300 - (i % 5) * 1e-4f, {i / 50, (i % 50) * 20000000}});
+    }
+
+    std::stringstream archive;
+    {
+        ArchiveWriter writer(archive, 100);
+        for (const OdometryValue& value : values)
+        {
+            writer.append(value);
+        }
+    }
+
+    ArchiveReader reader(archive);
+    size_t index = 0;
+    while (reader.nextChunk())
+    {
+        assert(reader.stream() == ArchiveStream::Odometry);
+        for (const OdometryValue& value : reader.odometryValues())
+        {
+            assert(std::memcmp(&value.speed, &values[index].speed, sizeof(float)) == 0);
+            assert(value.timestamp.secs == values[index].timestamp.secs);
+            assert(value.timestamp.nsecs == values[index].timestamp.nsecs);
+            index++;
+        }
+    }
+    assert(!reader.corrupted());
+    assert(index == values.size());
+}
+
+// Smooth 50 Hz data takes two bytes per record, truncated archives are reported
+void test_3()
+{
+    std::stringstream archive;
+    uint64_t bytes_written;
+    {
+        ArchiveWriter writer(archive, 1000);
+        for (uint32_t i = 0; i < 1000; i++)
+        {
+            writer.append(make_encoder_value(i * 7, {i / 50, (i % 50) * 20000000}), true);
+        }
+        writer.flush();
+        bytes_written = writer.bytesWritten();
+    }
+    assert(bytes_written < 2 * 1000 + 32);
+
+    std::string bytes = archive.str();
+    std::istringstream truncated(bytes.substr(0, bytes.size() - 1));
+    ArchiveReader reader(truncated);
+    assert(!reader.nextChunk());
+    assert(reader.corrupted());
+}
+
+// Ticks are kept at the encoder resolution recorded in each chunk, out of range ticks are rejected
+void test_4()
+{
+    std::vector<EncoderValue> left, right;
+    for (uint32_t i = 0; i < 300; i++)
+    {
+        left.push_back(make_encoder_value(((uint64_t(1) << 30) + (uint64_t(i) << 25)) & 0xffffffff, {i / 50, (i % 50) * 20000000}));
+        right.push_back(make_encoder_value((70000 - 500 * int64_t(i)) & 0xffff, {i / 50, (i % 50) * 20000000}));
+    }
+
+    std::stringstream archive;
+    {
+        ArchiveWriter writer(archive, 64, 32, 16);
+        for (size_t i = 0; i < left.size(); i++)
+        {
+            bool appended = writer.append(left[i], true) && writer.append(right[i], false);
+            assert(appended);
+        }
+        bool appended = writer.append(make_encoder_value(0x10000, {6, 0}), false);
+        assert(!appended);
+        appended = writer.append(make_encoder_value(-1, {6, 0}), true);
+        assert(!appended);
+    }
+
+    ArchiveReader reader(archive);
+    size_t left_index = 0, right_index = 0;
+    while (reader.nextChunk())
+    {
+        bool is_left = reader.stream() == ArchiveStream::LeftEncoder;
+        assert(reader.encoderBits() == (is_left ? 32 : 16));
+        for (const EncoderValue& encoder_value : reader.encoderValues())
+        {
+            const EncoderValue& expected = is_left ? left[left_index++] : right[right_index++];
+            assert(is_same_encoder_value(encoder_value, expected));
+        }
+    }
+    assert(!reader.corrupted());
+    assert(left_index == left.size());
+    assert(right_index == right.size());
+
+    std::stringstream narrow_archive;
+    ArchiveWriter narrow_writer(narrow_archive);
+    bool appended = narrow_writer.append(make_encoder_value(uint64_t(1) << 30, {0, 0}), true);
+    assert(!appended);
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "Test 1 "; test_1(); std::cout << "✔️" << std::endl;
+    std::cout << "Test 2 "; test_2(); std::cout << "✔️" << std::endl;
+    std::cout << "Test 3 "; test_3(); std::cout << "✔️" << std::endl;
+    std::cout << "Test 4 "; test_4(); std::cout << "✔️" << std::endl;
+}
@@ -0,0 +1,144 @@
+#include "odometry_batch.h"
+#include "test_helpers.h"
+#include <cassert>
+#include <iostream>
+#include <sstream>
+
+#define TICKS_PER_METER 300
+#define ENCODER_PERIOD_NSECS 20000000
+
+using farmwise_odometry::ArchiveWriter;
+using farmwise_odometry::BatchOptions;
+using farmwise_odometry::EncoderValue;
+using farmwise_odometry::LogSummary;
+using farmwise_odometry::is_same_float;
+using farmwise_odometry::make_encoder_value;
+
+// 1 m/s over 100 samples, overflowed, right sample 50 and left samples 70 and 71 dropped
+std::string make_log(size_t chunk_records)
+{
+    std::ostringstream archive;
+    ArchiveWriter writer(archive, chunk_records);
+    for (uint64_t i = 0; i < 100; i++)
+    {
+        EncoderValue encoder_value = make_encoder_value(EncoderValue::max_tick - 100 + 6 * i, i * ENCODER_PERIOD_NSECS);
+        if (i != 70 && i != 71)
+        {
+            writer.append(encoder_value, true);
+        }
+        if (i != 50)
+        {
+            writer.append(encoder_value, false);
+        }
+    }
+    writer.flush();
+    return archive.str();
+}
+
+// Summary of a log with dropped samples, whatever the chunking
+void test_1()
+{
+    BatchOptions options;
+    options.ticks_per_meter = TICKS_PER_METER;
+    for (size_t chunk_records : {7, 64, 4096})
+    {
+        std::istringstream in(make_log(chunk_records));
+        LogSummary summary;
+        assert(farmwise_odometry::summarizeLog(in, options, summary));
+        assert(summary.left_samples == 98 && summary.right_samples == 99);
+        assert(summary.paired_samples == 97);
+        assert(summary.unpaired_samples == 3);
+        assert(summary.dropped_left_samples == 2 && summary.dropped_right_samples == 1);
+        assert(summary.odometry_updates == 96);
+        assert(is_same_float(summary.duration, 1.98));
+        assert(is_same_float(summary.distance, 1.98));
+        assert(is_same_float(summary.mean_speed, 1) && is_same_float(summary.stddev_speed, 0));
+        assert(is_same_float(summary.min_speed, 1) && is_same_float(summary.max_speed, 1));
+    }
+}
+
+// Parallel summaries match sequential ones, corrupted logs are reported
+void test_2()
+{
+    std::vector<std::string> logs(37, make_log(16));
+    logs[5] = logs[5].substr(0, logs[5].size() / 2);
+
+    BatchOptions options;
+    options.ticks_per_meter = TICKS_PER_METER;
+    options.threads = 4;
+    options.chunk_logs = 3;
+    std::vector<LogSummary> summaries(logs.size());
+    farmwise_odometry::parallelFor(logs.size(), options, [&](size_t i)
+    {
+        std::istringstream in(logs[i]);
+        farmwise_odometry::summarizeLog(in, options, summaries[i]);
+    });
+
+    for (size_t i = 0; i < logs.size(); i++)
+    {
+        assert(summaries[i].ok == (i != 5));
+        if (i != 5)
+        {
+            assert(summaries[i].paired_samples == 97);
+            assert(summaries[i].distance == summaries[0].distance);
+        }
+    }
+}
+
+// Logs of 32-bit encoders are reported instead of being unwrapped at 24 bits
+void test_3()
+{
+    std::ostringstream archive;
+    {
+        ArchiveWriter writer(archive, 16, 32, 32);
+        for (uint64_t i = 0; i < 100; i++)
+        {
+            EncoderValue encoder_value = make_encoder_value(6 * i, i * ENCODER_PERIOD_NSECS);
+            encoder_value.tick += uint64_t(1) << 30;
+            writer.append(encoder_value, true);
+            writer.append(encoder_value, false);
+        }
+    }
+
+    BatchOptions options;
+    options.ticks_per_meter = TICKS_PER_METER;
+    std::istringstream in(archive.str());
+    LogSummary summary;
+    assert(!farmwise_odometry::summarizeLog(in, options, summary));
+    assert(!summary.ok && summary.paired_samples == 0);
+}
+
+// A silent right wheel does not hold back the left one, a late right wheel is replayed unpaired
+void test_4()
+{
+    std::ostringstream archive;
+    {
+        ArchiveWriter writer(archive, 64);
+        for (uint64_t i = 0; i < 10000; i++)
+        {
+            writer.append(make_encoder_value(6 * i, i * ENCODER_PERIOD_NSECS), true);
+        }
+        writer.flush();
+        for (uint64_t i = 0; i < 100; i++)
+        {
+            writer.append(make_encoder_value(6 * i, i * ENCODER_PERIOD_NSECS), false);
+        }
+    }
+
+    BatchOptions options;
+    options.ticks_per_meter = TICKS_PER_METER;
+    std::istringstream in(archive.str());
+    LogSummary summary;
+    assert(farmwise_odometry::summarizeLog(in, options, summary));
+    assert(summary.left_samples == 10000 && summary.right_samples == 100);
+    assert(summary.unpaired_samples == 10100 && summary.paired_samples == 0);
+    assert(summary.dropped_left_samples == 0 && summary.dropped_right_samples == 0);
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "Test 1 "; test_1(); std::cout << "✔️" << std::endl;
+    std::cout << "Test 2 "; test_2(); std::cout << "✔️" << std::endl;
+    std::cout << "Test 3 "; test_3(); std::cout << "✔️" << std::endl;
+    std::cout << "Test 4 "; test_4(); std::cout << "✔️" << std::endl;
+}
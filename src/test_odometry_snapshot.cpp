@@ -0,0 +1,205 @@
+#include "odometry_snapshot.h"
+#include "test_helpers.h"
+#include <cassert>
+#include <cstdio>
+#include <memory>
+#include <iostream>
+#include <sstream>
+#include <unistd.h>
+
+#define TICKS_PER_METER 300
+#define ENCODER_PERIOD_NSECS 20000000
+
+using farmwise_odometry::BasicFarmwiseOdometryWheels;
+using farmwise_odometry::Encoder24;
+using farmwise_odometry::Encoder32;
+using farmwise_odometry::EncoderValue;
+using farmwise_odometry::FarmwiseOdometryWheels;
+using farmwise_odometry::OdometrySnapshot;
+using farmwise_odometry::OdometryValue;
+using farmwise_odometry::is_same_float;
+using farmwise_odometry::make_encoder_value;
+using farmwise_odometry::to_nsecs;
+
+// Feeds samples [begin, end) of a constant speed drive to both wheels, overflowing the encoder
+void drive(FarmwiseOdometryWheels& odometry_wheels, uint64_t begin, uint64_t end)
+{
+    for (uint64_t i = begin; i < end; i++)
+    {
+        odometry_wheels.processLeftEncoder(make_encoder_value(EncoderValue::max_tick - 20 + 6 * i,
+                                                              i * ENCODER_PERIOD_NSECS));
+        odometry_wheels.processRightEncoder(make_encoder_value(EncoderValue::max_tick - 20 + 6 * i,
+                                                               i * ENCODER_PERIOD_NSECS));
+    }
+}
+
+// Round trip through the binary format, corrupted snapshots are rejected
+void test_1()
+{
+    FarmwiseOdometryWheels odometry_wheels(TICKS_PER_METER, std::chrono::milliseconds(10));
+    drive(odometry_wheels, 0, 100);
+    OdometrySnapshot snapshot;
+    assert(odometry_wheels.trySnapshot(snapshot));
+
+    std::stringstream bytes;
+    assert(farmwise_odometry::writeSnapshot(bytes, snapshot));
+    OdometrySnapshot restored;
+    assert(farmwise_odometry::readSnapshot(bytes, restored));
+    assert(restored.ticks_per_meter == TICKS_PER_METER);
+    assert(restored.left_encoder == Encoder24::id() && restored.right_encoder == Encoder24::id());
+    assert(restored.last_left_tick == snapshot.last_left_tick);
+    assert(restored.last_right_tick == snapshot.last_right_tick);
+    assert(restored.last_left_update == snapshot.last_left_update);
+    assert(restored.last_right_update == snapshot.last_right_update);
+    assert(restored.left_speed == snapshot.left_speed);
+    assert(restored.right_speed == snapshot.right_speed);
+    assert(restored.last_pair_update == snapshot.last_pair_update);
+    assert(restored.has_left_speed && restored.has_right_speed);
+    assert(restored.next_output == snapshot.next_output);
+    assert(restored.left_history.size() == snapshot.left_history.size());
+    for (size_t i = 0; i < snapshot.left_history.size(); i++)
+    {
+        assert(restored.left_history.at(i).time == snapshot.left_history.at(i).time);
+        assert(restored.left_history.at(i).speed == snapshot.left_history.at(i).speed);
+    }
+
+    std::string corrupted = bytes.str();
+    corrupted[20] ^= 1;
+    std::istringstream corrupted_bytes(corrupted);
+    assert(!farmwise_odometry::readSnapshot(corrupted_bytes, restored));
+
+    std::istringstream truncated_bytes(bytes.str().substr(0, 40));
+    assert(!farmwise_odometry::readSnapshot(truncated_bytes, restored));
+}
+
+// Warm start emits on the first paired sample, a cold start does not
+void test_2()
+{
+    FarmwiseOdometryWheels odometry_wheels(TICKS_PER_METER);
+    drive(odometry_wheels, 0, 5);
+    OdometrySnapshot snapshot;
+    assert(odometry_wheels.trySnapshot(snapshot));
+
+    OdometryValue odometry_value{};
+    FarmwiseOdometryWheels cold_odometry_wheels(TICKS_PER_METER);
+    drive(cold_odometry_wheels, 5, 6);
+    assert(!cold_odometry_wheels.updateOdometry(odometry_value));
+
+    FarmwiseOdometryWheels warm_odometry_wheels(TICKS_PER_METER, snapshot);
+    drive(warm_odometry_wheels, 5, 6);
+    assert(warm_odometry_wheels.updateOdometry(odometry_value));
+    assert(to_nsecs(odometry_value) == 5 * ENCODER_PERIOD_NSECS);
+    assert(is_same_float(odometry_value.speed, 6 / (TICKS_PER_METER * 0.02f)));
+
+    // Updates older than the snapshot restart the wheels
+    FarmwiseOdometryWheels stale_odometry_wheels(TICKS_PER_METER, snapshot);
+    drive(stale_odometry_wheels, 0, 1);
+    assert(!stale_odometry_wheels.updateOdometry(odometry_value));
+}
+
+// Warm start carries on the resampled output grid
+void test_3()
+{
+    FarmwiseOdometryWheels odometry_wheels(TICKS_PER_METER, std::chrono::milliseconds(10));
+    OdometryValue odometry_value{};
+    drive(odometry_wheels, 0, 5);
+    while (odometry_wheels.updateOdometry(odometry_value))
+    {
+    }
+    assert(to_nsecs(odometry_value) == 4 * ENCODER_PERIOD_NSECS);
+    OdometrySnapshot snapshot;
+    assert(odometry_wheels.trySnapshot(snapshot));
+
+    FarmwiseOdometryWheels warm_odometry_wheels(TICKS_PER_METER, snapshot, std::chrono::milliseconds(10));
+    drive(warm_odometry_wheels, 5, 6);
+    assert(warm_odometry_wheels.updateOdometry(odometry_value));
+    assert(to_nsecs(odometry_value) == 4 * ENCODER_PERIOD_NSECS + 10000000);
+    assert(warm_odometry_wheels.updateOdometry(odometry_value));
+    assert(to_nsecs(odometry_value) == 5 * ENCODER_PERIOD_NSECS);
+    assert(!warm_odometry_wheels.updateOdometry(odometry_value));
+}
+
+// Periodic checkpoints of a running estimator, restored after a restart
+void test_4()
+{
+    std::string path = "test_odometry_snapshot.bin";
+    std::remove(path.c_str());
+
+    auto odometry_wheels = std::make_shared<FarmwiseOdometryWheels>(TICKS_PER_METER);
+    odometry_wheels->start();
+    {
+        farmwise_odometry::SnapshotWriter snapshot_writer(*odometry_wheels, path, std::chrono::milliseconds(20));
+        for (uint64_t i = 0; i < 10; i++)
+        {
+            odometry_wheels->newEncoderUpdate(make_encoder_value(6 * i, i * ENCODER_PERIOD_NSECS), true);
+            odometry_wheels->newEncoderUpdate(make_encoder_value(6 * i, i * ENCODER_PERIOD_NSECS), false);
+        }
+        usleep(1e5);
+    }
+    odometry_wheels.reset();
+
+    OdometrySnapshot snapshot;
+    assert(farmwise_odometry::loadSnapshot(path, snapshot));
+    assert(snapshot.last_left_tick == 54 && snapshot.last_right_tick == 54);
+
+    odometry_wheels = std::make_shared<FarmwiseOdometryWheels>(TICKS_PER_METER, snapshot);
+    odometry_wheels->start();
+    odometry_wheels->newEncoderUpdate(make_encoder_value(60, 10 * ENCODER_PERIOD_NSECS), true);
+    odometry_wheels->newEncoderUpdate(make_encoder_value(60, 10 * ENCODER_PERIOD_NSECS), false);
+    usleep(1e5);
+    OdometryValue odometry_value{};
+    assert(odometry_wheels->getOdometryUpdate(odometry_value));
+    assert(is_same_float(odometry_value.speed, 6 / (TICKS_PER_METER * 0.02f)));
+    std::remove(path.c_str());
+}
+
+// Restarts long after the snapshot, or with another calibration or encoder model, start cold
+void test_5()
+{
+    FarmwiseOdometryWheels odometry_wheels(TICKS_PER_METER);
+    drive(odometry_wheels, 0, 5);
+    OdometrySnapshot snapshot;
+    assert(odometry_wheels.trySnapshot(snapshot));
+
+    // 1.5 m/s an hour after the snapshot at 0.08 s
+    OdometryValue odometry_value{};
+    FarmwiseOdometryWheels late_odometry_wheels(TICKS_PER_METER, snapshot);
+    assert(late_odometry_wheels.warmStarted());
+    for (uint64_t i = 0; i < 3; i++)
+    {
+        EncoderValue encoder_value = make_encoder_value(9 * (180000 + i), 3600000000000 + i * ENCODER_PERIOD_NSECS);
+        late_odometry_wheels.processLeftEncoder(encoder_value);
+        late_odometry_wheels.processRightEncoder(encoder_value);
+        if (i == 0)
+        {
+            assert(!late_odometry_wheels.updateOdometry(odometry_value));
+            continue;
+        }
+        assert(late_odometry_wheels.updateOdometry(odometry_value));
+        assert(is_same_float(odometry_value.speed, 1.5));
+    }
+
+    // A few missed samples are still unwrapped against the snapshot
+    FarmwiseOdometryWheels recent_odometry_wheels(TICKS_PER_METER, snapshot);
+    drive(recent_odometry_wheels, 4 + FarmwiseOdometryWheels::max_restore_gap_periods,
+          5 + FarmwiseOdometryWheels::max_restore_gap_periods);
+    assert(recent_odometry_wheels.updateOdometry(odometry_value));
+    assert(is_same_float(odometry_value.speed, 6 / (TICKS_PER_METER * 0.02f)));
+
+    FarmwiseOdometryWheels recalibrated_odometry_wheels(TICKS_PER_METER + 1, snapshot);
+    assert(!recalibrated_odometry_wheels.warmStarted());
+    drive(recalibrated_odometry_wheels, 5, 6);
+    assert(!recalibrated_odometry_wheels.updateOdometry(odometry_value));
+
+    BasicFarmwiseOdometryWheels<Encoder32, Encoder24> other_model_odometry_wheels(TICKS_PER_METER, snapshot);
+    assert(!other_model_odometry_wheels.warmStarted());
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "Test 1 "; test_1(); std::cout << "✔️" << std::endl;
+    std::cout << "Test 2 "; test_2(); std::cout << "✔️" << std::endl;
+    std::cout << "Test 3 "; test_3(); std::cout << "✔️" << std::endl;
+    std::cout << "Test 4 "; test_4(); std::cout << "✔️" << std::endl;
+    std::cout << "Test 5 "; test_5(); std::cout << "✔️" << std::endl;
+}
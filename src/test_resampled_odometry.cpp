@@ -0,0 +1,205 @@
+#include "odometry_wheels.h"
+#include "test_helpers.h"
+#include <cassert>
+#include <memory>
+#include <iostream>
+#include <unistd.h>
+
+#define TICKS_PER_METER 300
+#define ENCODER_PERIOD_NSECS 20000000
+#define OUTPUT_PERIOD_NSECS 10000000
+
+using farmwise_odometry::EncoderValue;
+using farmwise_odometry::FarmwiseOdometryWheels;
+using farmwise_odometry::OdometryValue;
+using farmwise_odometry::is_same_float;
+using farmwise_odometry::make_encoder_value;
+using farmwise_odometry::to_nsecs;
+
+// Constant speed, right stream offset by 7 ms and lagging: output stays on the 10 ms grid
+void test_1()
+{
+    FarmwiseOdometryWheels odometry_wheels(TICKS_PER_METER, std::chrono::milliseconds(10));
+    OdometryValue odometry_value{};
+    for (uint64_t i = 0; i < 10; i++)
+    {
+        odometry_wheels.processLeftEncoder(make_encoder_value(EncoderValue::max_tick - 20 + 6 * i,
+                                                              1000000000 + i * ENCODER_PERIOD_NSECS));
+    }
+    assert(!odometry_wheels.updateOdometry(odometry_value));
+
+    uint64_t last_nsecs = 0;
+    int outputs = 0;
+    for (uint64_t i = 0; i < 10; i++)
+    {
+        odometry_wheels.processRightEncoder(make_encoder_value(EncoderValue::max_tick - 20 + 6 * i,
+                                                               1007000000 + i * ENCODER_PERIOD_NSECS));
+        while (odometry_wheels.updateOdometry(odometry_value))
+        {
+            uint64_t nsecs = to_nsecs(odometry_value);
+            assert(nsecs % OUTPUT_PERIOD_NSECS == 0);
+            assert(last_nsecs == 0 || nsecs == last_nsecs + OUTPUT_PERIOD_NSECS);
+            assert(is_same_float(odometry_value.speed, 6 / (TICKS_PER_METER * 0.02f)));
+            last_nsecs = nsecs;
+            outputs++;
+        }
+    }
+    // Right speeds cover [1.027 s, 1.187 s], grid ticks 1.03 s to 1.18 s
+    assert(outputs == 16);
+}
+
+// Speeding up, wheel speeds are interpolated between encoder samples
+void test_2()
+{
+    FarmwiseOdometryWheels odometry_wheels(TICKS_PER_METER, std::chrono::milliseconds(10));
+    OdometryValue odometry_value{};
+    int64_t tick = 0;
+    for (uint64_t i = 0; i < 10; i++)
+    {
+        tick += i;
+        odometry_wheels.processLeftEncoder(make_encoder_value(tick, i * ENCODER_PERIOD_NSECS));
+        odometry_wheels.processRightEncoder(make_encoder_value(tick, i * ENCODER_PERIOD_NSECS));
+        if (i == 0)
+        {
+            assert(!odometry_wheels.updateOdometry(odometry_value));
+            continue;
+        }
+        if (i == 1)
+        {
+            assert(odometry_wheels.updateOdometry(odometry_value));
+            assert(to_nsecs(odometry_value) == ENCODER_PERIOD_NSECS);
+            assert(!odometry_wheels.updateOdometry(odometry_value));
+            continue;
+        }
+
+        // Grid ticks in the middle of the encoder period, then on the encoder sample
+        assert(odometry_wheels.updateOdometry(odometry_value));
+        assert(to_nsecs(odometry_value) == i * ENCODER_PERIOD_NSECS - OUTPUT_PERIOD_NSECS);
+        assert(is_same_float(odometry_value.speed, (i - 0.5f) / (TICKS_PER_METER * 0.02f)));
+        assert(odometry_wheels.updateOdometry(odometry_value));
+        assert(to_nsecs(odometry_value) == i * ENCODER_PERIOD_NSECS);
+        assert(is_same_float(odometry_value.speed, i / (TICKS_PER_METER * 0.02f)));
+        assert(!odometry_wheels.updateOdometry(odometry_value));
+    }
+}
+
+// Timer-driven output thread publishes every grid tick
+void test_3()
+{
+    auto odometry_wheels = std::make_shared<FarmwiseOdometryWheels>(TICKS_PER_METER, std::chrono::milliseconds(10));
+    odometry_wheels->start();
+    for (uint64_t i = 0; i < 11; i++)
+    {
+        odometry_wheels->newEncoderUpdate(make_encoder_value(3 * i, i * ENCODER_PERIOD_NSECS), true);
+        odometry_wheels->newEncoderUpdate(make_encoder_value(3 * i, i * ENCODER_PERIOD_NSECS), false);
+    }
+    usleep(2e5);
+
+    OdometryValue odometry_value{};
+    uint64_t outputs = 0;
+    while (odometry_wheels->getOdometryUpdate(odometry_value))
+    {
+        assert(to_nsecs(odometry_value) == ENCODER_PERIOD_NSECS + outputs * OUTPUT_PERIOD_NSECS);
+        outputs++;
+    }
+    assert(outputs == 19);
+}
+
+// A reader falling behind gets the newest grid ticks, the oldest ones are dropped
+void test_4()
+{
+    auto odometry_wheels = std::make_shared<FarmwiseOdometryWheels>(TICKS_PER_METER, std::chrono::milliseconds(10));
+    odometry_wheels->start();
+    for (uint64_t i = 0; i < 200; i++)
+    {
+        odometry_wheels->newEncoderUpdate(make_encoder_value(3 * i, i * ENCODER_PERIOD_NSECS), true);
+        odometry_wheels->newEncoderUpdate(make_encoder_value(3 * i, i * ENCODER_PERIOD_NSECS), false);
+        // Within the speed history capacity between two odometry wakeups
+        if (i % 20 == 19)
+        {
+            usleep(5e4);
+        }
+    }
+    usleep(2e5);
+
+    // 397 grid ticks from 20 ms to 3.98 s, of which the queue keeps the last 128
+    OdometryValue odometry_value{};
+    uint64_t outputs = 0;
+    while (odometry_wheels->getOdometryUpdate(odometry_value))
+    {
+        assert(to_nsecs(odometry_value) == 199 * uint64_t(ENCODER_PERIOD_NSECS) - (127 - outputs) * OUTPUT_PERIOD_NSECS);
+        outputs++;
+    }
+    assert(outputs == 128);
+}
+
+// A second start() is ignored, nothing is processed while stopped, start() resumes after stop()
+void test_5()
+{
+    auto odometry_wheels = std::make_shared<FarmwiseOdometryWheels>(TICKS_PER_METER, std::chrono::milliseconds(10));
+    odometry_wheels->start();
+    odometry_wheels->start();
+    OdometryValue odometry_value{};
+    uint64_t outputs = 0;
+    for (uint64_t i = 0; i < 11; i++)
+    {
+        if (i == 6)
+        {
+            usleep(1e5);
+            while (odometry_wheels->getOdometryUpdate(odometry_value))
+            {
+                outputs++;
+            }
+            assert(outputs == 9);
+            odometry_wheels->stop();
+        }
+        odometry_wheels->newEncoderUpdate(make_encoder_value(3 * i, i * ENCODER_PERIOD_NSECS), true);
+        odometry_wheels->newEncoderUpdate(make_encoder_value(3 * i, i * ENCODER_PERIOD_NSECS), false);
+    }
+    usleep(1e5);
+    assert(!odometry_wheels->getOdometryUpdate(odometry_value));
+
+    odometry_wheels->start();
+    usleep(1e5);
+    while (odometry_wheels->getOdometryUpdate(odometry_value))
+    {
+        outputs++;
+    }
+    assert(outputs == 19);
+    assert(to_nsecs(odometry_value) == 10 * ENCODER_PERIOD_NSECS);
+}
+
+// Duplicated and reordered updates are discarded without a gap in the grid
+void test_6()
+{
+    FarmwiseOdometryWheels odometry_wheels(TICKS_PER_METER, std::chrono::milliseconds(10));
+    OdometryValue odometry_value{};
+    uint64_t outputs = 0;
+    for (uint64_t i = 0; i < 11; i++)
+    {
+        odometry_wheels.processLeftEncoder(make_encoder_value(3 * i, i * ENCODER_PERIOD_NSECS));
+        odometry_wheels.processRightEncoder(make_encoder_value(3 * i, i * ENCODER_PERIOD_NSECS));
+        if (i == 4)
+        {
+            odometry_wheels.processLeftEncoder(make_encoder_value(3 * i, i * ENCODER_PERIOD_NSECS));
+            odometry_wheels.processRightEncoder(make_encoder_value(3 * (i - 1), (i - 1) * ENCODER_PERIOD_NSECS));
+        }
+        while (odometry_wheels.updateOdometry(odometry_value))
+        {
+            assert(to_nsecs(odometry_value) == ENCODER_PERIOD_NSECS + outputs * OUTPUT_PERIOD_NSECS);
+            assert(is_same_float(odometry_value.speed, 3 / (TICKS_PER_METER * 0.02f)));
+            outputs++;
+        }
+    }
+    assert(outputs == 19);
+}
+
+int main(int argc, char** argv)
+{
+    std::cout << "Test 1 "; test_1(); std::cout << "✔️" << std::endl;
+    std::cout << "Test 2 "; test_2(); std::cout << "✔️" << std::endl;
+    std::cout << "Test 3 "; test_3(); std::cout << "✔️" << std::endl;
+    std::cout << "Test 4 "; test_4(); std::cout << "✔️" << std::endl;
+    std::cout << "Test 5 "; test_5(); std::cout << "✔️" << std::endl;
+    std::cout << "Test 6 "; test_6(); std::cout << "✔️" << std::endl;
+}